@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "BatchManifest.h"
+
+namespace
+{
+    bool toVector(const juce::var& value, Vector3<float>& vector)
+    {
+        if (!value.isArray() || value.size() != 3)
+            return false;
+
+        vector = { (float)value[0], (float)value[1], (float)value[2] };
+        return true;
+    }
+
+    /** Reads a vector given as an array of 3 numbers, or as X, Y and Z fields (CSV columns). */
+    bool readVector(const juce::var& fields, const juce::String& name, Vector3<float>& vector, bool& found, juce::String& error)
+    {
+        juce::var value = fields.getProperty(juce::Identifier(name), {});
+        if (!value.isVoid())
+        {
+            if (!toVector(value, vector))
+            {
+                error = name + " must be an array of 3 numbers";
+                return false;
+            }
+
+            found = true;
+            return true;
+        }
+
+        const char* axes[] = { "X", "Y", "Z" };
+        float* components[] = { &vector.x, &vector.y, &vector.z };
+        for (int axis = 0; axis < 3; axis++)
+        {
+            juce::var component = fields.getProperty(juce::Identifier(name + axes[axis]), {});
+            if (!component.isVoid())
+            {
+                *components[axis] = (float)component;
+                found = true;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool readNumber(const juce::var& fields, const char* name, T& number, T minimum, T maximum, juce::String& error)
+    {
+        juce::var value = fields.getProperty(juce::Identifier(name), {});
+        if (value.isVoid())
+            return true;
+
+        T read = value.isString() ? (T)value.toString().getDoubleValue() : (T)(double)value;
+        if (!(read >= minimum && read <= maximum))
+        {
+            error = juce::String(name) + (maximum < std::numeric_limits<T>::max()
+                                              ? " must be between " + juce::String(minimum) + " and " + juce::String(maximum)
+                                              : " must be at least " + juce::String(minimum));
+            return false;
+        }
+
+        number = read;
+        return true;
+    }
+
+    template <typename T>
+    bool readNumber(const juce::var& fields, const char* name, T& number, T minimum, juce::String& error)
+    {
+        return readNumber(fields, name, number, minimum, std::numeric_limits<T>::max(), error);
+    }
+
+    // CSV cells become numbers where they are numbers, so CSV and JSON scenes read the same
+    juce::var parseCell(const juce::String& text)
+    {
+        juce::String cell = text.trim().unquoted();
+        if (cell.isNotEmpty() && cell.containsOnly("0123456789.-+eE") && cell.containsAnyOf("0123456789"))
+            return cell.getDoubleValue();
+        return cell;
+    }
+
+    bool readCsv(const juce::File& file, const BatchScene& defaults, std::vector<BatchScene>& scenes, juce::String& error)
+    {
+        juce::StringArray lines;
+        file.readLines(lines);
+
+        juce::StringArray columns;
+        int row = 0;
+        for (auto& line : lines)
+        {
+            row++;
+            if (line.trim().isEmpty() || line.trimStart().startsWithChar('#'))
+                continue;
+
+            auto cells = juce::StringArray::fromTokens(line, ",", "\"");
+            if (columns.isEmpty())
+            {
+                for (auto& cell : cells)
+                    columns.add(cell.trim().unquoted());
+                continue;
+            }
+
+            juce::DynamicObject::Ptr fields = new juce::DynamicObject();
+            for (int column = 0; column < juce::jmin(columns.size(), cells.size()); column++)
+                fields->setProperty(juce::Identifier(columns[column]), parseCell(cells[column]));
+
+            BatchScene scene = defaults;
+            scene.name = "scene-" + juce::String((int)scenes.size() + 1);
+            if (!BatchManifest::applyFields(juce::var(fields.get()), scene, error))
+            {
+                error = file.getFileName() + " line " + juce::String(row) + ": " + error;
+                return false;
+            }
+            scenes.push_back(std::move(scene));
+        }
+
+        return true;
+    }
+
+    bool readJson(const juce::File& file, const BatchScene& defaults, std::vector<BatchScene>& scenes, juce::String& error)
+    {
+        juce::var manifest;
+        juce::Result parsed = juce::JSON::parse(file.loadFileAsString(), manifest);
+        if (parsed.failed())
+        {
+            error = file.getFileName() + ": " + parsed.getErrorMessage();
+            return false;
+        }
+
+        BatchScene base = defaults;
+        juce::var list = manifest;
+        if (manifest.isObject())
+        {
+            if (manifest.hasProperty("defaults") && !BatchManifest::applyFields(manifest["defaults"], base, error))
+            {
+                error = file.getFileName() + " defaults: " + error;
+                return false;
+            }
+            list = manifest["scenes"];
+        }
+
+        if (!list.isArray())
+        {
+            error = file.getFileName() + " has no array of scenes";
+            return false;
+        }
+
+        for (int i = 0; i < list.size(); i++)
+        {
+            BatchScene scene = base;
+            scene.name = "scene-" + juce::String(i + 1);
+            if (!BatchManifest::applyFields(list[i], scene, error))
+            {
+                error = file.getFileName() + " scene " + juce::String(i + 1) + ": " + error;
+                return false;
+            }
+            scenes.push_back(std::move(scene));
+        }
+
+        return true;
+    }
+
+    bool isInside(Vector3<float> min, Vector3<float> max, Vector3<float> innerMin, Vector3<float> innerMax)
+    {
+        return innerMin.x >= min.x && innerMin.y >= min.y && innerMin.z >= min.z
+            && innerMax.x <= max.x && innerMax.y <= max.y && innerMax.z <= max.z;
+    }
+
+    /** Rejects rooms the tracer can't make sense of: empty rooms, and listeners or sources outside the room. */
+    bool checkGeometry(const SharedData& scene, juce::String& error)
+    {
+        if (!(scene.roomSize.x > 0.0f && scene.roomSize.y > 0.0f && scene.roomSize.z > 0.0f))
+        {
+            error = "roomSize must be positive";
+            return false;
+        }
+
+        if (!(scene.listenerSize.x > 0.0f && scene.listenerSize.y > 0.0f && scene.listenerSize.z > 0.0f))
+        {
+            error = "listenerSize must be positive";
+            return false;
+        }
+
+        Vector3<float> roomMin = scene.roomPos - scene.roomSize * 0.5f, roomMax = scene.roomPos + scene.roomSize * 0.5f;
+        if (!isInside(roomMin, roomMax, scene.listenerPos - scene.listenerSize * 0.5f, scene.listenerPos + scene.listenerSize * 0.5f))
+        {
+            error = "The listener box must be inside the room";
+            return false;
+        }
+
+        for (size_t source = 0; source < scene.soundSourcePositions.size(); source++)
+        {
+            if (!isInside(roomMin, roomMax, scene.soundSourcePositions[source], scene.soundSourcePositions[source]))
+            {
+                error = "Source " + juce::String((int)source + 1) + " must be inside the room";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** Checks each scene's room, and that no two scenes share a name (their golden results) or an output file. */
+    bool checkScenes(const juce::File& file, const std::vector<BatchScene>& scenes, juce::String& error)
+    {
+        juce::StringArray names, files;
+        for (size_t i = 0; i < scenes.size(); i++)
+        {
+            auto& scene = scenes[i];
+            juce::String where = file.getFileName() + " scene " + juce::String((int)i + 1) + " (" + scene.name + "): ";
+            if (!checkGeometry(scene.scene, error))
+            {
+                error = where + error;
+                return false;
+            }
+
+            // Names and files are compared as the file system will see them
+            juce::String name = juce::File::createLegalFileName(scene.name).toLowerCase();
+            juce::String fileName = scene.getOutputFileName().replaceCharacter('\\', '/').toLowerCase();
+            if (names.contains(name))
+            {
+                error = where + "another scene has the same name";
+                return false;
+            }
+            if (files.contains(fileName))
+            {
+                error = where + "another scene writes the same file";
+                return false;
+            }
+
+            names.add(name);
+            files.add(fileName);
+        }
+
+        return true;
+    }
+}
+
+juce::String BatchScene::getOutputFileName() const
+{
+    if (fileName.isNotEmpty())
+        return fileName;
+
+    return juce::File::createLegalFileName(name) + (exportSettings.format == IRExportSettings::Format::flac ? ".flac" : ".wav");
+}
+
+bool BatchManifest::read(const juce::File& file, const BatchScene& defaults, std::vector<BatchScene>& scenes, juce::String& error)
+{
+    if (!file.existsAsFile())
+    {
+        error = "Can't find " + file.getFullPathName();
+        return false;
+    }
+
+    bool parsed = file.hasFileExtension("csv") ? readCsv(file, defaults, scenes, error) : readJson(file, defaults, scenes, error);
+    return parsed && checkScenes(file, scenes, error);
+}
+
+bool BatchManifest::applyFields(const juce::var& fields, BatchScene& batchScene, juce::String& error)
+{
+    if (!fields.isObject())
+    {
+        error = "A scene must be an object";
+        return false;
+    }
+
+    SharedData& scene = batchScene.scene;
+    bool found = false; // the room and listener always have a value, given or not
+    if (!readVector(fields, "roomSize", scene.roomSize, found, error) || !readVector(fields, "roomPos", scene.roomPos, found, error)
+        || !readVector(fields, "listenerPos", scene.listenerPos, found, error) || !readVector(fields, "listenerSize", scene.listenerSize, found, error))
+        return false;
+
+    juce::var sources = fields.getProperty("sources", {});
+    if (sources.isArray())
+    {
+        scene.soundSourcePositions.clear();
+        for (int i = 0; i < sources.size(); i++)
+        {
+            Vector3<float> position;
+            if (!toVector(sources[i], position))
+            {
+                error = "sources must be an array of arrays of 3 numbers";
+                return false;
+            }
+            scene.soundSourcePositions.push_back(position);
+        }
+    }
+    else
+    {
+        bool foundSource = false;
+        Vector3<float> position = scene.soundSourcePositions.empty() ? Vector3<float>() : scene.soundSourcePositions.front();
+        if (!readVector(fields, "source", position, foundSource, error))
+            return false;
+        if (foundSource)
+            scene.soundSourcePositions = { position };
+    }
+
+    if (scene.soundSourcePositions.empty())
+    {
+        error = "A scene needs at least one source";
+        return false;
+    }
+
+    if (!readNumber(fields, "speedOfSound", scene.speedOfSound, 1.0f, error)
+        || !readNumber(fields, "rollOff", scene.rollOff, 0.0f, error)
+        || !readNumber(fields, "delayBucketSize", scene.delayBucketSize, 1e-4f, error)
+        || !readNumber(fields, "refinementTolerance", scene.refinementTolerance, 0.0f, error)
+        || !readNumber(fields, "additionalRays", scene.additionalRays, 0, SharedData::Limits::additionalRays, error)
+        || !readNumber(fields, "numberPolarBuckets", scene.numberPolarBuckets, 1, SharedData::Limits::numberPolarBuckets, error)
+        || !readNumber(fields, "maxRefinementRounds", scene.maxRefinementRounds, 0, SharedData::Limits::maxRefinementRounds, error)
+        || !readNumber(fields, "numReflections", scene.numReflections, 1, SharedData::Limits::numReflections, error)
+        || !readNumber(fields, "receiverGridX", scene.receiverGridX, 0, SharedData::Limits::receiverGridSize, error)
+        || !readNumber(fields, "receiverGridY", scene.receiverGridY, 0, SharedData::Limits::receiverGridSize, error)
+        || !readNumber(fields, "receiverGridZ", scene.receiverGridZ, 0, SharedData::Limits::receiverGridSize, error)
+        || !readNumber(fields, "sampleRate", batchScene.exportSettings.sampleRate, 1000.0, error))
+        return false;
+
+    if (fields.hasProperty("name"))
+        batchScene.name = fields["name"].toString();
+    if (fields.hasProperty("file"))
+        batchScene.fileName = fields["file"].toString();
+
+    if (fields.hasProperty("format") && !parseFormat(fields["format"].toString(), batchScene.exportSettings.format))
+    {
+        error = "Unknown format " + fields["format"].toString() + ", use wav32, wav24 or flac";
+        return false;
+    }
+
+    if (fields.hasProperty("layout") && !parseLayout(fields["layout"].toString(), batchScene.exportSettings.layout))
+    {
+        error = "Unknown layout " + fields["layout"].toString() + ", use mono, stereo, binaural or ambisonic";
+        return false;
+    }
+
+    return true;
+}
+
+bool BatchManifest::parseFormat(const juce::String& text, IRExportSettings::Format& format)
+{
+    if (text == "wav32" || text == "wav")
+        format = IRExportSettings::Format::wavFloat;
+    else if (text == "wav24")
+        format = IRExportSettings::Format::wav24;
+    else if (text == "flac")
+        format = IRExportSettings::Format::flac;
+    else
+        return false;
+    return true;
+}
+
+bool BatchManifest::parseLayout(const juce::String& text, IRExportSettings::Layout& layout)
+{
+    if (text == "mono")
+        layout = IRExportSettings::Layout::mono;
+    else if (text == "stereo")
+        layout = IRExportSettings::Layout::stereo;
+    else if (text == "binaural")
+        layout = IRExportSettings::Layout::binaural;
+    else if (text == "ambisonic")
+        layout = IRExportSettings::Layout::ambisonic;
+    else
+        return false;
+    return true;
+}
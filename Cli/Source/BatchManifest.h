@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <vector>
+#include <JuceHeader.h>
+
+// One scene of a batch render and how its IR is written
+struct BatchScene {
+    juce::String name;
+    SharedData scene;
+    juce::String fileName;           // relative to the output directory; empty for the name with the format's extension
+    IRExportSettings exportSettings; // the file is set by the renderer
+
+    /** The file name relative to the output directory, from fileName or the name. */
+    juce::String getOutputFileName() const;
+};
+
+/***************************************************************/
+// Reads the scenes of a batch render from a JSON or CSV manifest.
+//
+// JSON is either an array of scenes, or an object with an array
+// of "scenes" and an optional object of "defaults" applied to
+// every scene first. Each scene is an object of SharedData's
+// fields by name, e.g.
+//
+//     { "name": "hall", "roomSize": [30, 12, 20], "roomPos": [15, 6, 10],
+//       "listenerPos": [10, 1.5, 8], "sources": [[20, 2, 12]],
+//       "numReflections": 20, "format": "wav24", "layout": "binaural",
+//       "sampleRate": 96000, "file": "halls/hall.wav" }
+//
+// CSV has a header row naming the same fields, with vectors split
+// into X, Y and Z columns (roomSizeX, roomSizeY, ...) and one
+// source per row (sourceX, sourceY, sourceZ).
+//
+// Fields left out keep the plugin's defaults, see SharedData.
+// Every room must be positive and hold its listener box and
+// sources, and no two scenes may share a name or output file.
+/***************************************************************/
+namespace BatchManifest
+{
+    /** Reads every scene of the manifest on top of the given defaults. Returns false, and why, if it can't be read. */
+    bool read(const juce::File& file, const BatchScene& defaults, std::vector<BatchScene>& scenes, juce::String& error);
+
+    /** Applies the fields of one JSON object (or CSV row) to a scene. Returns false, and why, if a field is invalid. */
+    bool applyFields(const juce::var& fields, BatchScene& scene, juce::String& error);
+
+    bool parseFormat(const juce::String& text, IRExportSettings::Format& format);
+    bool parseLayout(const juce::String& text, IRExportSettings::Layout& layout);
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "BatchRenderer.h"
+
+int BatchSceneStats::getNumFailedChecks() const
+{
+    int numFailed = 0;
+    for (auto& check : checks)
+        numFailed += check.failures.isNotEmpty() ? 1 : 0;
+    return numFailed;
+}
+
+BatchRenderer::BatchRenderer(const Options& optionsIn) : options(optionsIn) {}
+
+std::vector<BatchSceneStats> BatchRenderer::render(const std::vector<BatchScene>& scenes, SceneCallback onSceneFinished)
+{
+    std::vector<BatchSceneStats> stats(scenes.size());
+    if (scenes.empty())
+        return stats;
+
+    int numWorkers = options.numWorkers > 0 ? options.numWorkers : juce::SystemStats::getNumCpus();
+    numWorkers = juce::jlimit(1, (int)scenes.size(), numWorkers);
+
+    RoomReverbCore::Options coreOptions;
+    coreOptions.maxWorkspaceBytes = options.maxWorkspaceBytes;
+    coreOptions.useIRCache = options.useIRCache;
+
+    // The core is destroyed first, while the pool can still run its jobs
+    juce::ThreadPool pool(numWorkers);
+    RoomReverbCore core(pool, coreOptions);
+
+    std::atomic<int> remaining{ (int)scenes.size() };
+    juce::WaitableEvent finished;
+
+    for (size_t scene = 0; scene < scenes.size(); scene++)
+    {
+        pool.addJob([this, &scenes, &stats, &core, &remaining, &finished, &onSceneFinished, scene]
+        {
+            stats[scene] = renderScene(scenes[scene], core);
+
+            if (onSceneFinished != nullptr)
+            {
+                std::lock_guard<std::mutex> lock(callbackMutex);
+                onSceneFinished(stats[scene]);
+            }
+
+            if (--remaining == 0)
+                finished.signal();
+        });
+    }
+
+    finished.wait(-1);
+    return stats;
+}
+
+BatchSceneStats BatchRenderer::renderScene(const BatchScene& batchScene, RoomReverbCore& core)
+{
+    BatchSceneStats sceneStats;
+    sceneStats.name = batchScene.name;
+
+    IRExportSettings settings = batchScene.exportSettings;
+    settings.file = options.outputDirectory.getChildFile(batchScene.getOutputFileName());
+    settings.directionBuckets = batchScene.scene.numberPolarBuckets;
+
+    TraceJob job(RoomReverbCore::prepareScene(batchScene.scene), nullptr);
+    if (options.logTraces)
+        job.traceLogFile = settings.file.withFileExtension("rrlog");
+
+    RoomReverbCore::TraceStats traceStats;
+    auto result = core.traceNow(job, &traceStats);
+    double traced = juce::Time::getMillisecondCounterHiRes();
+    sceneStats.worker = traceStats.tracer;
+    sceneStats.traceSeconds = traceStats.seconds;
+    sceneStats.workspaceBytes = traceStats.workspaceBytes;
+
+    if (result == nullptr)
+    {
+        sceneStats.error = "The trace was cancelled";
+        return sceneStats;
+    }
+
+    sceneStats.numSources = (int)result->sources.size();
+    for (int source = 0; source < sceneStats.numSources; source++)
+    {
+        auto& listenerIR = result->sources[(size_t)source].listenerIR;
+        sceneStats.numTaps += (int)listenerIR.size();
+        if (!listenerIR.empty())
+            sceneStats.irSeconds = juce::jmax(sceneStats.irSeconds, listenerIR.back().delay / 1000.0);
+
+        IRExportSettings sourceSettings = settings;
+        sourceSettings.file = settings.getSourceFile(source);
+
+        juce::String error;
+        if (!IRExporter::writeIR(listenerIR, sourceSettings, error))
+        {
+            sceneStats.error = sourceSettings.file.getFileName() + ": " + error;
+            break;
+        }
+        sceneStats.files.add(sourceSettings.file);
+    }
+
+    sceneStats.exportSeconds = (juce::Time::getMillisecondCounterHiRes() - traced) / 1000.0;
+
+    checkScene(*job.scene, *result, sceneStats);
+    return sceneStats;
+}
+
+void BatchRenderer::checkScene(const SharedData& scene, const TraceResult& result, BatchSceneStats& sceneStats)
+{
+    if (options.goldenDirectory != juce::File())
+    {
+        juce::File goldenFile = options.goldenDirectory.getChildFile(juce::File::createLegalFileName(sceneStats.name) + ".rrgolden");
+        if (options.updateGolden)
+        {
+            sceneStats.goldenRecorded = GoldenIR::write(goldenFile, scene, result);
+            if (!sceneStats.goldenRecorded)
+                sceneStats.checks.push_back({ "golden", {}, "can't write " + goldenFile.getFullPathName() });
+        }
+        else if (!goldenFile.existsAsFile())
+        {
+            // A missing golden is a failure, never recorded silently: it may be a wrong directory or a renamed scene
+            sceneStats.checks.push_back({ "golden", {}, "no golden result " + goldenFile.getFullPathName() });
+        }
+        else
+        {
+            BatchCheck check{ "golden", {}, {} };
+            juce::String error;
+            if (auto golden = GoldenIR::read(goldenFile, scene, error))
+            {
+                check.comparison = GoldenIR::compare(*golden, result, {});
+                check.comparison.passes(options.goldenTolerances, check.failures);
+            }
+            else
+            {
+                check.failures = error;
+            }
+
+            sceneStats.checks.push_back(check);
+        }
+    }
+
+    if (options.checkImageSources && isShoeboxRoom(scene))
+    {
+        BatchCheck check{ "image sources", {}, {} };
+        for (int source = 0; source < (int)result.sources.size(); source++)
+            check.comparison.mergeWorst(IRComparison::compare(traceImageSources(scene, source), result.sources[(size_t)source].listenerIR,
+                                                              getImageSourceSettings(scene)));
+
+        check.comparison.passes(options.imageSourceTolerances, check.failures);
+        sceneStats.checks.push_back(check);
+    }
+}
+
+bool BatchRenderer::writeStats(const juce::File& file, const std::vector<BatchSceneStats>& stats)
+{
+    juce::String csv = "scene,worker,traceSeconds,exportSeconds,sources,taps,irSeconds,workspaceMB,files,error\n";
+    for (auto& scene : stats)
+    {
+        juce::StringArray files;
+        for (auto& sceneFile : scene.files)
+            files.add(sceneFile.getFileName());
+
+        csv << scene.name.quoted() << "," << scene.worker << ","
+            << juce::String(scene.traceSeconds, 3) << "," << juce::String(scene.exportSeconds, 3) << ","
+            << scene.numSources << "," << scene.numTaps << "," << juce::String(scene.irSeconds, 3) << ","
+            << juce::String((double)scene.workspaceBytes / (1024.0 * 1024.0), 1) << ","
+            << files.joinIntoString(";").quoted() << "," << scene.error.quoted() << "\n";
+    }
+
+    return file.replaceWithText(csv);
+}
+
+bool BatchRenderer::writeChecks(const juce::File& file, const std::vector<BatchSceneStats>& stats)
+{
+    juce::String csv = "scene,reference,referenceTaps,taps,matchedTaps,energyMatched,extraEnergy,tapLevelErrorDb,maxDelayErrorMs,edcErrorDb,spectralDistanceDb,failures\n";
+    for (auto& scene : stats)
+    {
+        for (auto& check : scene.checks)
+        {
+            auto& comparison = check.comparison;
+            csv << scene.name.quoted() << "," << check.reference.quoted() << ","
+                << comparison.referenceTaps << "," << comparison.testTaps << "," << comparison.matchedTaps << ","
+                << juce::String(comparison.energyMatched, 4) << "," << juce::String(comparison.extraEnergy, 4) << ","
+                << juce::String(comparison.tapLevelErrorDb, 2) << "," << juce::String(comparison.maxDelayErrorMs, 3) << ","
+                << juce::String(comparison.edcErrorDb, 2) << "," << juce::String(comparison.spectralDistanceDb, 2) << ","
+                << check.failures.quoted() << "\n";
+        }
+    }
+
+    return file.replaceWithText(csv);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <JuceHeader.h>
+#include "BatchManifest.h"
+
+// A check of a scene's result against a reference, see IRComparison
+struct BatchCheck {
+    juce::String reference;  // "golden" or "image sources"
+    IRComparison comparison; // the worst of each metric over the sources and receivers compared
+    juce::String failures;   // empty if the check passed
+};
+
+// What rendering one scene of a batch took
+struct BatchSceneStats {
+    juce::String name;
+    juce::String error;        // empty if the scene rendered
+    int worker = 0;            // the tracer that ran the scene, see RoomReverbCore::TraceStats
+    double traceSeconds = 0.0, exportSeconds = 0.0;
+    int numSources = 0;
+    int numTaps = 0;           // listener taps over every source
+    double irSeconds = 0.0;    // length of the longest IR
+    size_t workspaceBytes = 0; // working memory the tracer kept after the scene
+    juce::Array<juce::File> files;
+    bool goldenRecorded = false; // the result was stored as the scene's golden result
+    std::vector<BatchCheck> checks;
+
+    int getNumFailedChecks() const;
+};
+
+/***************************************************************/
+// Traces the scenes of a batch and writes their IRs, several
+// scenes at once.
+//
+// The scenes are jobs on a thread pool with a worker per core,
+// traced through RoomReverbCore: each running trace has its own
+// tracer and working memory, bounded so that no tracer keeps
+// more than the limit between scenes. Nothing here needs a
+// message thread, a GUI or OpenGL.
+/***************************************************************/
+class BatchRenderer
+{
+public:
+    struct Options {
+        juce::File outputDirectory;
+        int numWorkers = 0;                        // 0 for one per core
+        size_t maxWorkspaceBytes = 512 * 1024 * 1024; // working memory each tracer keeps between scenes
+        bool useIRCache = false;                   // reuse and fill the plugin's IR cache, which skews the timings
+        bool logTraces = false;                    // write a TraceLog next to each IR
+
+        // Regression and accuracy checks, see GoldenIR and traceImageSources()
+        juce::File goldenDirectory;                // if set, each scene's result is checked against its golden result here
+        bool updateGolden = false;                 // store each result as the scene's golden one instead; otherwise a missing one fails
+        bool checkImageSources = false;            // check the listener IRs of shoebox scenes against their image sources
+        IRComparison::Tolerances goldenTolerances;
+        IRComparison::Tolerances imageSourceTolerances = getImageSourceTolerances();
+    };
+
+    /** Called on a worker thread as each scene finishes, one call at a time. */
+    using SceneCallback = std::function<void(const BatchSceneStats&)>;
+
+    explicit BatchRenderer(const Options& options);
+
+    /** Renders every scene and returns their stats, in the order of the scenes. */
+    std::vector<BatchSceneStats> render(const std::vector<BatchScene>& scenes, SceneCallback onSceneFinished = nullptr);
+
+    /** Writes the stats as CSV, one row per scene. */
+    static bool writeStats(const juce::File& file, const std::vector<BatchSceneStats>& stats);
+
+    /** Writes the checks as CSV, one row per check of each scene. */
+    static bool writeChecks(const juce::File& file, const std::vector<BatchSceneStats>& stats);
+
+private:
+    BatchSceneStats renderScene(const BatchScene& scene, RoomReverbCore& core);
+    void checkScene(const SharedData& scene, const TraceResult& result, BatchSceneStats& sceneStats);
+
+    const Options options;
+    std::mutex callbackMutex;
+};
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+/***************************************************************/
+// Command line batch renderer: traces every scene of a manifest
+// and writes their IRs and timings, without a GUI, see
+// BatchManifest for the manifest and BatchRenderer for the work.
+// With --golden it is also the engine's regression check: run it
+// on the fixed scenes in Cli/Regression before and after a change,
+// along with --self-test for the unit tests.
+/***************************************************************/
+
+#include <iostream>
+#include <JuceHeader.h>
+#include "BatchManifest.h"
+#include "BatchRenderer.h"
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "Usage: RoomReverbCli <manifest.json|manifest.csv> [options]\n"
+                     "       RoomReverbCli --self-test\n"
+                     "\n"
+                     "  --output <directory>   where IRs and stats.csv are written (default: \"<manifest> IRs\" next to it)\n"
+                     "  --jobs <n>             scenes traced at once (default: one per core)\n"
+                     "  --workspace-mb <n>     working memory each worker keeps between scenes (default: 512)\n"
+                     "  --format <format>      wav32, wav24 or flac (default: wav32)\n"
+                     "  --layout <layout>      mono, stereo, binaural or ambisonic (default: stereo)\n"
+                     "  --rate <hz>            sample rate (default: 48000)\n"
+                     "  --cache                reuse and fill the plugin's IR cache\n"
+                     "  --trace-log            write a binary trace log next to each IR\n"
+                     "  --golden <directory>   check each scene against its golden result there; a missing one fails\n"
+                     "  --update-golden        store every scene's result as its golden result\n"
+                     "  --image-source         check shoebox scenes against their exact image source IRs\n"
+                     "  --self-test            run the unit tests of the engine and the plugin instead of rendering\n"
+                     "\n"
+                     "Scenes and files can override the format, layout and rate. Checks are written to\n"
+                     "verify.csv; the exit code is 3 if any failed.\n";
+    }
+
+    bool fail(const juce::String& message)
+    {
+        std::cerr << message << "\n";
+        return false;
+    }
+
+    // Runs the RoomReverb unit tests, which are compiled in with JUCE_UNIT_TESTS=1, and returns the exit code
+    int runSelfTest()
+    {
+        juce::UnitTestRunner runner;
+        runner.setAssertOnFailure(false);
+        runner.runTestsInCategory("RoomReverb");
+
+        if (runner.getNumResults() == 0)
+        {
+            std::cerr << "No unit tests were compiled in; build with JUCE_UNIT_TESTS=1\n";
+            return 1;
+        }
+
+        int numPasses = 0, numFailures = 0;
+        for (int i = 0; i < runner.getNumResults(); i++)
+        {
+            numPasses += runner.getResult(i)->passes;
+            numFailures += runner.getResult(i)->failures;
+        }
+
+        std::cout << numPasses << " of " << (numPasses + numFailures) << " unit test checks passed\n";
+        return numFailures == 0 ? 0 : 3;
+    }
+
+    bool parseArguments(const juce::StringArray& args, juce::File& manifest, BatchScene& defaults, BatchRenderer::Options& options)
+    {
+        for (int i = 0; i < args.size(); i++)
+        {
+            const juce::String& arg = args[i];
+            bool hasValue = i + 1 < args.size();
+            juce::String value = hasValue ? args[i + 1] : juce::String();
+
+            if (!arg.startsWith("--"))
+            {
+                if (manifest != juce::File())
+                    return fail("Only one manifest can be given");
+                manifest = juce::File::getCurrentWorkingDirectory().getChildFile(arg);
+                continue;
+            }
+
+            if (arg == "--cache")
+            {
+                options.useIRCache = true;
+                continue;
+            }
+            if (arg == "--trace-log")
+            {
+                options.logTraces = true;
+                continue;
+            }
+            if (arg == "--update-golden")
+            {
+                options.updateGolden = true;
+                continue;
+            }
+            if (arg == "--image-source")
+            {
+                options.checkImageSources = true;
+                continue;
+            }
+
+            if (!hasValue)
+                return fail(arg + " needs a value");
+            i++;
+
+            if (arg == "--output")
+                options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (arg == "--jobs")
+                options.numWorkers = juce::jmax(1, value.getIntValue());
+            else if (arg == "--golden")
+                options.goldenDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (arg == "--workspace-mb")
+                options.maxWorkspaceBytes = (size_t)juce::jmax(0, value.getIntValue()) * 1024 * 1024;
+            else if (arg == "--rate" && value.getDoubleValue() >= 1000.0)
+                defaults.exportSettings.sampleRate = value.getDoubleValue();
+            else if (arg == "--format" && BatchManifest::parseFormat(value, defaults.exportSettings.format))
+                continue;
+            else if (arg == "--layout" && BatchManifest::parseLayout(value, defaults.exportSettings.layout))
+                continue;
+            else
+                return fail("Invalid option " + arg + " " + value);
+        }
+
+        if (manifest == juce::File())
+            return fail("No manifest given");
+        if (options.updateGolden && options.goldenDirectory == juce::File())
+            return fail("--update-golden needs --golden");
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; i++)
+        args.add(juce::String(argv[i]));
+
+    if (args.isEmpty() || args.contains("--help") || args.contains("-h"))
+    {
+        printUsage();
+        return args.isEmpty() ? 1 : 0;
+    }
+
+    if (args.contains("--self-test"))
+        return runSelfTest();
+
+    juce::File manifest;
+    BatchScene defaults;
+    BatchRenderer::Options options;
+    if (!parseArguments(args, manifest, defaults, options))
+        return 1;
+
+    std::vector<BatchScene> scenes;
+    juce::String error;
+    if (!BatchManifest::read(manifest, defaults, scenes, error))
+    {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    if (options.outputDirectory == juce::File())
+        options.outputDirectory = manifest.getSiblingFile(manifest.getFileNameWithoutExtension() + " IRs");
+    if (!options.outputDirectory.createDirectory())
+    {
+        std::cerr << "Can't create " << options.outputDirectory.getFullPathName() << "\n";
+        return 1;
+    }
+
+    std::cout << "Rendering " << scenes.size() << " scenes to " << options.outputDirectory.getFullPathName() << "\n";
+
+    double start = juce::Time::getMillisecondCounterHiRes();
+    BatchRenderer renderer(options);
+    auto stats = renderer.render(scenes, [](const BatchSceneStats& scene)
+    {
+        if (scene.error.isNotEmpty())
+            std::cout << scene.name << ": failed, " << scene.error << "\n";
+        else
+            std::cout << scene.name << ": traced in " << juce::String(scene.traceSeconds, 2) << " s, written in "
+                      << juce::String(scene.exportSeconds, 2) << " s, " << scene.numTaps << " taps\n";
+
+        if (scene.goldenRecorded)
+            std::cout << scene.name << ": stored as the golden result\n";
+        for (auto& check : scene.checks)
+            std::cout << scene.name << ": " << check.reference << (check.failures.isEmpty() ? " passed" : " FAILED, " + check.failures) << "\n";
+    });
+    double seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+    juce::File statsFile = options.outputDirectory.getChildFile("stats.csv");
+    if (!BatchRenderer::writeStats(statsFile, stats))
+        std::cerr << "Can't write " << statsFile.getFullPathName() << "\n";
+
+    int numFailed = 0, numChecks = 0, numFailedChecks = 0;
+    double traceSeconds = 0.0;
+    for (auto& scene : stats)
+    {
+        numFailed += scene.error.isNotEmpty() ? 1 : 0;
+        numChecks += (int)scene.checks.size();
+        numFailedChecks += scene.getNumFailedChecks();
+        traceSeconds += scene.traceSeconds;
+    }
+
+    std::cout << (scenes.size() - (size_t)numFailed) << " of " << scenes.size() << " scenes rendered in " << juce::String(seconds, 2)
+              << " s (" << juce::String(traceSeconds, 2) << " s of tracing)\n";
+
+    if (numChecks > 0)
+    {
+        juce::File checksFile = options.outputDirectory.getChildFile("verify.csv");
+        if (!BatchRenderer::writeChecks(checksFile, stats))
+            std::cerr << "Can't write " << checksFile.getFullPathName() << "\n";
+
+        std::cout << (numChecks - numFailedChecks) << " of " << numChecks << " checks passed\n";
+    }
+
+    if (numFailed > 0)
+        return 2;
+    return numFailedChecks == 0 ? 0 : 3;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "ConvolutionPool.h"
+
+#if JUCE_WINDOWS
+struct ConvolutionPool::WakeSemaphore::Native {
+    HANDLE semaphore = CreateSemaphoreW(nullptr, 0, LONG_MAX, nullptr);
+    ~Native() { CloseHandle(semaphore); }
+    void post() noexcept { ReleaseSemaphore(semaphore, 1, nullptr); }
+    void wait() noexcept { WaitForSingleObject(semaphore, INFINITE); }
+};
+#elif JUCE_MAC || JUCE_IOS
+struct ConvolutionPool::WakeSemaphore::Native {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    ~Native() { dispatch_release(semaphore); }
+    void post() noexcept { dispatch_semaphore_signal(semaphore); }
+    void wait() noexcept { dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER); }
+};
+#else
+struct ConvolutionPool::WakeSemaphore::Native {
+    sem_t semaphore;
+    Native() { sem_init(&semaphore, 0, 0); }
+    ~Native() { sem_destroy(&semaphore); }
+    void post() noexcept { sem_post(&semaphore); }
+    void wait() noexcept { while (sem_wait(&semaphore) != 0 && errno == EINTR) {} }
+};
+#endif
+
+ConvolutionPool::WakeSemaphore::WakeSemaphore() : native(std::make_unique<Native>()) {}
+ConvolutionPool::WakeSemaphore::~WakeSemaphore() = default;
+void ConvolutionPool::WakeSemaphore::post() noexcept { native->post(); }
+void ConvolutionPool::WakeSemaphore::wait() noexcept { native->wait(); }
+
+ConvolutionPool::ConvolutionPool()
+{
+    for (int i = 0; i < getNumWorkers(); i++)
+    {
+        workers.push_back(std::make_unique<Worker>(*this));
+        workers.back()->startThread();
+    }
+}
+
+ConvolutionPool::~ConvolutionPool()
+{
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (size_t i = 0; i < workers.size(); i++)
+        wake.post();
+
+    for (auto& worker : workers)
+        worker->stopThread(4000);
+}
+
+/***************************************************************/
+// Half the cores, like the TraceScheduler, leaving the rest to
+// the host's audio threads.
+/***************************************************************/
+int ConvolutionPool::getNumWorkers()
+{
+    return juce::jmax(1, juce::SystemStats::getNumCpus() / 2);
+}
+
+void ConvolutionPool::addTask(ConvolutionTask* task)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(task);
+}
+
+void ConvolutionPool::removeTask(ConvolutionTask* task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.erase(std::remove(tasks.begin(), tasks.end(), task), tasks.end());
+    }
+
+    // Workers only claim tasks under the lock, so once removed it can only be finishing its current work
+    while (task->running.load())
+        juce::Thread::yield();
+}
+
+/***************************************************************/
+// The task has already published its work, so a worker that is
+// not counted as sleeping yet will find it when it looks again
+// before waiting. Only when one may be waiting does the audio
+// thread post the semaphore.
+/***************************************************************/
+void ConvolutionPool::notifyWorkPosted() noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepingWorkers.load() > 0)
+        wake.post();
+}
+
+ConvolutionPool::Counters ConvolutionPool::getCounters() const noexcept
+{
+    Counters counters;
+    counters.jobsRun = jobsRun.load();
+    counters.lateJobs = lateJobs.load();
+    counters.missedDeadlines = missedDeadlines.load();
+    return counters;
+}
+
+/***************************************************************/
+// Claim the task whose pending work is due soonest, or return
+// nullptr if no task has any. Tasks with work already running
+// are skipped, as their work has to run in order.
+/***************************************************************/
+ConvolutionTask* ConvolutionPool::takeEarliestTask()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ConvolutionTask* earliest = nullptr;
+    double earliestDeadline = 0.0;
+    bool morePending = false;
+    for (auto* task : tasks)
+    {
+        double deadline = task->getNextDeadline();
+        if (deadline < 0.0 || task->running.load())
+            continue;
+
+        if (earliest != nullptr)
+            morePending = true;
+
+        if (earliest == nullptr || deadline < earliestDeadline)
+        {
+            earliest = task;
+            earliestDeadline = deadline;
+        }
+    }
+
+    if (earliest != nullptr)
+        earliest->running = true;
+
+    // Several tasks may have posted while the workers slept, so wake another one to share them out
+    if (morePending && sleepingWorkers.load() > 0)
+        wake.post();
+
+    return earliest;
+}
+
+void ConvolutionPool::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        auto* task = pool.takeEarliestTask();
+        if (task == nullptr)
+        {
+            // Count ourselves as sleeping before looking once more, so work posted in between
+            // is either found by that look or posts the semaphore, see notifyWorkPosted()
+            pool.sleepingWorkers++;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            task = pool.takeEarliestTask();
+            if (task == nullptr && !threadShouldExit())
+                pool.wake.wait();
+            pool.sleepingWorkers--;
+
+            if (task == nullptr)
+                continue;
+        }
+
+        double deadline = task->getNextDeadline();
+        task->runNext();
+        if (juce::Time::getMillisecondCounterHiRes() > deadline)
+            pool.lateJobs++;
+        pool.jobsRun++;
+
+        task->running = false;
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <juce_dsp/juce_dsp.h>
+
+/***************************************************************/
+// Background work of one convolver, run by the ConvolutionPool.
+// The audio thread posts work by updating the task's atomics,
+// never by taking a lock.
+/***************************************************************/
+class ConvolutionTask
+{
+public:
+    virtual ~ConvolutionTask() = default;
+
+    /** Time (Time::getMillisecondCounterHiRes()) by which the oldest pending work must be done, or a negative value if there is none. */
+    virtual double getNextDeadline() const = 0;
+
+    /** Runs the oldest pending work. Never called by two workers at once. */
+    virtual void runNext() = 0;
+
+private:
+    friend class ConvolutionPool;
+    std::atomic<bool> running{ false };
+};
+
+/***************************************************************/
+// The workers that run the long-partition FFT work of every
+// convolver in the process, so a session with many instances
+// doesn't start a thread per reverb.
+//
+// Pending work is run earliest deadline first, across all the
+// tasks. Workers sleep while there is nothing to do, so the CPU
+// used follows the work rather than the number of threads. They
+// sleep on a semaphore rather than an event, as posting work
+// from the audio thread must not take a lock.
+/***************************************************************/
+class ConvolutionPool
+{
+public:
+    ConvolutionPool();
+    ~ConvolutionPool();
+
+    /** Adds a task. Not to be called from the audio thread. */
+    void addTask(ConvolutionTask* task);
+
+    /** Removes a task, waiting for its running work to finish. Not to be called from the audio thread. */
+    void removeTask(ConvolutionTask* task);
+
+    /** Wakes a sleeping worker after a task has posted work. Lock-free, for the audio thread. */
+    void notifyWorkPosted() noexcept;
+
+    /** Called by a convolver that found its work unfinished when the audio thread needed it. */
+    void reportMissedDeadline() noexcept { missedDeadlines++; }
+
+    struct Counters {
+        juce::uint64 jobsRun = 0;
+        juce::uint64 lateJobs = 0;        // finished after their deadline
+        juce::uint64 missedDeadlines = 0; // not finished when the audio thread needed them
+    };
+
+    Counters getCounters() const noexcept;
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(ConvolutionPool& owner) : juce::Thread("ConvolutionPool"), pool(owner) {}
+        void run() override;
+
+    private:
+        ConvolutionPool& pool;
+    };
+
+    // A counting semaphore: a futex on Linux, a dispatch semaphore on Apple platforms and a
+    // kernel semaphore on Windows. None takes a user space lock to post, and a post made
+    // before the worker waits is kept rather than lost.
+    class WakeSemaphore
+    {
+    public:
+        WakeSemaphore();
+        ~WakeSemaphore();
+
+        void post() noexcept;
+        void wait() noexcept;
+
+    private:
+        struct Native;
+        std::unique_ptr<Native> native;
+
+        JUCE_DECLARE_NON_COPYABLE(WakeSemaphore)
+    };
+
+    static int getNumWorkers();
+    ConvolutionTask* takeEarliestTask();
+
+    std::mutex mutex; // guards tasks, only taken by workers and when adding or removing tasks
+    std::vector<ConvolutionTask*> tasks;
+    WakeSemaphore wake;
+    std::atomic<int> sleepingWorkers{ 0 }; // workers about to wait on, or waiting on, the semaphore
+    std::atomic<juce::uint64> jobsRun{ 0 }, lateJobs{ 0 }, missedDeadlines{ 0 };
+    std::vector<std::unique_ptr<Worker>> workers;
+};
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#include "HeadConvolver.h"
+
+void HeadConvolver::prepare(const juce::dsp::ProcessSpec& spec, int newHeadLength, int newFadeLength)
+{
+    blockSize = juce::jmax(64, juce::nextPowerOfTwo((int)spec.maximumBlockSize));
+    numBins = blockSize + 1;
+    numChannels = (int)spec.numChannels;
+    headLength = newHeadLength;
+    fftOrder = juce::roundToInt(std::log2(2.0 * blockSize));
+    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+    // One slot more than the partitions, for the block being collected
+    delayLineLength = (headLength + blockSize - 1) / blockSize + 1;
+    window.assign((size_t)numChannels, std::vector<float>((size_t)(2 * blockSize), 0.0f));
+    delayLine.assign((size_t)numChannels, std::vector<std::complex<float>>((size_t)(delayLineLength * numBins)));
+    currentSums.assign((size_t)numChannels, std::vector<std::complex<float>>((size_t)numBins));
+    previousSums.assign((size_t)numChannels, std::vector<std::complex<float>>((size_t)numBins));
+    fftBuffer.assign((size_t)(4 * blockSize), 0.0f);
+    fadeBuffer.assign((size_t)blockSize, 0.0f);
+
+    current = previous = nullptr;
+    fadeLength = fadePosition = newFadeLength;
+    delayLinePosition = position = 0;
+}
+
+void HeadConvolver::reset()
+{
+    for (auto* buffers : { &delayLine, &currentSums, &previousSums })
+        for (auto& channel : *buffers)
+            std::fill(channel.begin(), channel.end(), std::complex<float>());
+    for (auto& channel : window)
+        std::fill(channel.begin(), channel.end(), 0.0f);
+
+    previous = nullptr;
+    fadePosition = fadeLength;
+    position = 0;
+}
+
+std::shared_ptr<const HeadConvolver::HeadSpectra> HeadConvolver::createSpectra(const juce::AudioBuffer<float>& ir) const
+{
+    int length = juce::jmin(ir.getNumSamples(), headLength);
+    if (blockSize == 0 || length <= 0 || ir.getNumChannels() == 0)
+        return nullptr;
+
+    auto spectra = std::make_shared<HeadSpectra>();
+    spectra->numChannels = ir.getNumChannels();
+    spectra->numPartitions = (length + blockSize - 1) / blockSize;
+    spectra->numBins = numBins;
+    spectra->bins.resize((size_t)spectra->numChannels * spectra->numPartitions * numBins);
+
+    // A transform of our own, as the audio thread may be using the other one
+    juce::dsp::FFT transform(fftOrder);
+    std::vector<float> buffer((size_t)(4 * blockSize));
+    for (int channel = 0; channel < spectra->numChannels; channel++)
+    {
+        for (int partition = 0; partition < spectra->numPartitions; partition++)
+        {
+            int start = partition * blockSize;
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+            std::copy_n(ir.getReadPointer(channel, start), juce::jmin(blockSize, length - start), buffer.begin());
+
+            transform.performRealOnlyForwardTransform(buffer.data(), true);
+            auto* bins = reinterpret_cast<const std::complex<float>*>(buffer.data());
+            std::copy_n(bins, numBins, spectra->bins.begin() + ((size_t)channel * spectra->numPartitions + partition) * numBins);
+        }
+    }
+
+    return spectra;
+}
+
+void HeadConvolver::setSpectra(const HeadSpectra* newSpectra)
+{
+    if (newSpectra == current)
+        return;
+
+    jassert(newSpectra == nullptr || newSpectra->numBins == numBins);
+
+    // The sums of the earlier blocks so far carry on with the old IR, the new one needs its own
+    previous = current;
+    current = newSpectra;
+    std::swap(previousSums, currentSums);
+    sumEarlierBlocks(current, currentSums);
+    fadePosition = 0;
+}
+
+void HeadConvolver::process(juce::AudioBuffer<float>& buffer)
+{
+    int numSamples = buffer.getNumSamples();
+    int channels = juce::jmin(numChannels, buffer.getNumChannels());
+    for (int channel = channels; channel < buffer.getNumChannels(); channel++)
+        buffer.clear(channel, 0, numSamples);
+
+    for (int start = 0; start < numSamples;)
+    {
+        int count = juce::jmin(numSamples - start, blockSize - position);
+        bool fading = isFading();
+
+        for (int channel = 0; channel < channels; channel++)
+        {
+            auto* samples = buffer.getWritePointer(channel, start);
+            std::copy_n(samples, count, window[(size_t)channel].begin() + blockSize + position);
+
+            // The block so far, zero padded, goes in the delay line slot it takes when it's finished
+            std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+            std::copy(window[(size_t)channel].begin(), window[(size_t)channel].end(), fftBuffer.begin());
+            fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+            auto* bins = reinterpret_cast<const std::complex<float>*>(fftBuffer.data());
+            std::copy_n(bins, numBins, delayLine[(size_t)channel].begin() + (size_t)((delayLinePosition + 1) % delayLineLength) * numBins);
+
+            if (current != nullptr)
+                convolveBlock(*current, channel, currentSums[(size_t)channel], samples, count);
+            else
+                std::fill_n(samples, count, 0.0f);
+
+            if (fading)
+            {
+                if (previous != nullptr)
+                    convolveBlock(*previous, channel, previousSums[(size_t)channel], fadeBuffer.data(), count);
+                else
+                    std::fill_n(fadeBuffer.begin(), count, 0.0f);
+
+                for (int i = 0; i < count; i++)
+                {
+                    float fade = juce::jmin(1.0f, (fadePosition + i + 1.0f) / fadeLength);
+                    samples[i] = fadeBuffer[(size_t)i] + fade * (samples[i] - fadeBuffer[(size_t)i]);
+                }
+            }
+        }
+
+        if (fading)
+        {
+            fadePosition = juce::jmin(fadeLength, fadePosition + count);
+            if (!isFading())
+                previous = nullptr;
+        }
+
+        start += count;
+        position += count;
+        if (position == blockSize)
+            blockFinished();
+    }
+}
+
+/***************************************************************/
+// End of a block: its spectrum joins the delay line, the window
+// moves on by a block, and the later partitions of the IR are
+// summed over the blocks so far, ready for the next block.
+/***************************************************************/
+void HeadConvolver::blockFinished()
+{
+    position = 0;
+    delayLinePosition = (delayLinePosition + 1) % delayLineLength;
+
+    for (auto& channelWindow : window)
+    {
+        std::copy(channelWindow.begin() + blockSize, channelWindow.end(), channelWindow.begin());
+        std::fill(channelWindow.begin() + blockSize, channelWindow.end(), 0.0f);
+    }
+
+    sumEarlierBlocks(current, currentSums);
+    if (isFading())
+        sumEarlierBlocks(previous, previousSums);
+}
+
+void HeadConvolver::sumEarlierBlocks(const HeadSpectra* spectra, std::vector<std::vector<std::complex<float>>>& sums)
+{
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        auto& sum = sums[(size_t)channel];
+        std::fill(sum.begin(), sum.end(), std::complex<float>());
+        if (spectra == nullptr)
+            continue;
+
+        // Partition 1 goes with the newest finished block, partition 2 with the one before, ...
+        int irChannel = juce::jmin(channel, spectra->numChannels - 1);
+        int numPartitions = juce::jmin(spectra->numPartitions, delayLineLength - 1);
+        for (int partition = 1; partition < numPartitions; partition++)
+        {
+            auto* x = delayLine[(size_t)channel].data() + (size_t)((delayLinePosition - (partition - 1) + delayLineLength) % delayLineLength) * numBins;
+            auto* h = spectra->get(irChannel, partition);
+            for (int bin = 0; bin < numBins; bin++)
+            {
+                // Written out, as std::complex multiplication checks for infinities
+                float xr = x[bin].real(), xi = x[bin].imag(), hr = h[bin].real(), hi = h[bin].imag();
+                sum[(size_t)bin] += std::complex<float>(xr * hr - xi * hi, xr * hi + xi * hr);
+            }
+        }
+    }
+}
+
+/***************************************************************/
+// The output of the block so far: its spectrum times the first
+// partition, plus the earlier blocks, transformed back. The
+// second half of the window is the linear convolution.
+/***************************************************************/
+void HeadConvolver::convolveBlock(const HeadSpectra& spectra, int channel, const std::vector<std::complex<float>>& earlier, float* output, int count)
+{
+    int irChannel = juce::jmin(channel, spectra.numChannels - 1);
+    auto* x = delayLine[(size_t)channel].data() + (size_t)((delayLinePosition + 1) % delayLineLength) * numBins;
+    auto* h = spectra.get(irChannel, 0);
+
+    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    auto* bins = reinterpret_cast<std::complex<float>*>(fftBuffer.data());
+    for (int bin = 0; bin < numBins; bin++)
+    {
+        float xr = x[bin].real(), xi = x[bin].imag(), hr = h[bin].real(), hi = h[bin].imag();
+        bins[bin] = earlier[(size_t)bin] + std::complex<float>(xr * hr - xi * hi, xr * hi + xi * hr);
+    }
+    fft->performRealOnlyInverseTransform(fftBuffer.data());
+
+    std::copy_n(fftBuffer.begin() + blockSize + position, count, output);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#pragma once
+#include <complex>
+#include <memory>
+#include <vector>
+#include <juce_dsp/juce_dsp.h>
+
+/***************************************************************/
+// Convolves audio with the start of an IR on the audio thread,
+// with no latency, up to where TailConvolver takes over.
+//
+// Uniformly partitioned overlap-save with partitions of the
+// block size. The partitions of earlier blocks are summed once
+// per block; each call only adds the block so far, zero padded,
+// so the output of every sample is ready as soon as its input.
+//
+// The spectra of an IR are made off the audio thread and swapped
+// in on it, fading from the old IR to the new one, so the swap
+// can be lined up with other work on the audio thread.
+/***************************************************************/
+class HeadConvolver
+{
+public:
+    // Partition spectra of the head, [channel][partition][bin]
+    struct HeadSpectra {
+        int numChannels = 0, numPartitions = 0, numBins = 0;
+        std::vector<std::complex<float>> bins;
+
+        const std::complex<float>* get(int channel, int partition) const { return bins.data() + ((size_t)channel * numPartitions + partition) * numBins; }
+    };
+
+    /** Prepares for IRs of up to headLength samples, fading over fadeLength samples when they're swapped. */
+    void prepare(const juce::dsp::ProcessSpec& spec, int headLength, int fadeLength);
+    void reset();
+
+    /** Transforms the first headLength samples of an IR, one channel per audio channel or one for all. Returns nullptr for an empty IR. */
+    std::shared_ptr<const HeadSpectra> createSpectra(const juce::AudioBuffer<float>& ir) const;
+
+    /** Swaps in spectra from createSpectra(), or nullptr for silence. They must outlive their use, until the next swap's fade is over. Audio thread only. */
+    void setSpectra(const HeadSpectra* newSpectra);
+
+    /** True while fading from the previous spectra, which are still in use until then. */
+    bool isFading() const { return fadePosition < fadeLength; }
+
+    /** Replaces the contents of buffer with its convolution with the head. */
+    void process(juce::AudioBuffer<float>& buffer);
+
+private:
+    void blockFinished();
+    void sumEarlierBlocks(const HeadSpectra* spectra, std::vector<std::vector<std::complex<float>>>& sums);
+    void convolveBlock(const HeadSpectra& spectra, int channel, const std::vector<std::complex<float>>& earlier, float* output, int count);
+
+    int blockSize = 0, numBins = 0, numChannels = 0, headLength = 0, fftOrder = 0;
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    const HeadSpectra* current = nullptr;
+    const HeadSpectra* previous = nullptr;
+    int fadeLength = 0, fadePosition = 0;
+
+    std::vector<std::vector<float>> window;                     // previous block and the block so far, by channel
+    std::vector<std::vector<std::complex<float>>> delayLine;    // spectra of finished blocks, by channel, newest at delayLinePosition
+    std::vector<std::vector<std::complex<float>>> currentSums;  // earlier blocks convolved with the current spectra, by channel
+    std::vector<std::vector<std::complex<float>>> previousSums; // and with the previous spectra while fading
+    int delayLineLength = 0, delayLinePosition = 0, position = 0;
+    std::vector<std::complex<float>> blockSpectrum;
+    std::vector<float> fftBuffer, fadeBuffer;
+};
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#include "RoomConvolver.h"
+#include "../ir/ImpulseResponse.h"
+
+void RoomConvolver::prepare(const juce::dsp::ProcessSpec& spec, Profile newProfile)
+{
+    profile = newProfile;
+    if (profile == Profile::offline)
+    {
+        tail.prepareOffline(spec);
+    }
+    else
+    {
+        tail.prepare(spec);
+        head.prepare(spec, tail.getTailStart(), TailConvolver::getPartitionSize((int)spec.maximumBlockSize));
+    }
+
+    // IRs of the old partition sizes are no use, the IR has to be loaded again
+    loadedIRs.clear();
+    std::atomic_store(&pendingIR, std::shared_ptr<const StagedIR>());
+    hasPendingIR = false;
+    activeIR = fadingIR = nullptr;
+    headWaiting = false;
+
+    tailBuffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize);
+    sampleRate = spec.sampleRate;
+}
+
+void RoomConvolver::reset()
+{
+    head.reset();
+    tail.reset();
+    silentSamples = 0;
+    idle = false;
+}
+
+void RoomConvolver::loadImpulseResponse(juce::AudioBuffer<float>&& ir, double irSampleRate)
+{
+    // The caller renders IRs at the rate it prepared us with
+    if (irSampleRate != sampleRate)
+    {
+        jassertfalse;
+        return;
+    }
+
+    decayTime = getDecayLength(ir, DECAY_FLOOR_DB) / irSampleRate;
+
+    if (profile == Profile::offline)
+    {
+        tail.setImpulseResponse(ir);
+        return;
+    }
+
+    auto staged = std::make_shared<StagedIR>();
+    staged->head = head.createSpectra(ir);
+    staged->tail = tail.createSpectra(ir);
+
+    // IRs only this list still holds are done with: the audio thread only takes the pending one
+    loadedIRs.erase(std::remove_if(loadedIRs.begin(), loadedIRs.end(), [](const std::shared_ptr<const StagedIR>& loaded) { return loaded.use_count() == 1; }),
+                    loadedIRs.end());
+    loadedIRs.push_back(staged);
+
+    std::atomic_store(&pendingIR, std::shared_ptr<const StagedIR>(std::move(staged)));
+    hasPendingIR = true;
+}
+
+/***************************************************************/
+// Swaps the pending IR in, once the previous swap has faded out.
+// The tail takes it straight away, but only starts playing it a
+// partition or two later, when the pool has convolved with it;
+// the head follows on that sample, see processHead(). The old
+// IRs are only let go of here, never freed, as loadedIRs still
+// holds them.
+/***************************************************************/
+void RoomConvolver::swapInPendingIR()
+{
+    if (headWaiting || head.isFading() || !hasPendingIR.exchange(false))
+        return;
+
+    auto pending = std::atomic_load(&pendingIR);
+    if (pending == activeIR)
+        return;
+
+    fadingIR = std::move(activeIR);
+    activeIR = std::move(pending);
+    tail.setSpectra(activeIR->tail);
+
+    // Only a tail fading from one IR to another has to be waited for; not while idle either
+    headWaiting = !idle && activeIR->tail != nullptr && fadingIR != nullptr && fadingIR->tail != nullptr;
+    if (!headWaiting)
+        head.setSpectra(activeIR->head.get());
+}
+
+void RoomConvolver::processHead(juce::AudioBuffer<float>& buffer)
+{
+    int offset = tail.getSpectraSwitchOffset();
+    if (!headWaiting || offset < 0 || tail.getPlayingSpectra() != activeIR->tail.get())
+    {
+        head.process(buffer);
+        return;
+    }
+
+    // The tail started fading to the new IR at this offset, so fade the head with it
+    juce::AudioBuffer<float> before(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), 0, offset);
+    juce::AudioBuffer<float> after(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), offset, buffer.getNumSamples() - offset);
+    head.process(before);
+    head.setSpectra(activeIR->head.get());
+    head.process(after);
+    headWaiting = false;
+}
+
+void RoomConvolver::process(juce::AudioBuffer<float>& buffer)
+{
+    int numSamples = buffer.getNumSamples();
+
+    // getMagnitude() is a vectorised min/max search, so this costs next to nothing
+    float peak = 0.0f;
+    for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+        peak = juce::jmax(peak, buffer.getMagnitude(channel, 0, numSamples));
+
+    if (profile == Profile::realtime)
+        swapInPendingIR();
+
+    if (peak > juce::Decibels::decibelsToGain(SILENCE_THRESHOLD_DB))
+    {
+        // Start again from silence, rather than from whatever was left when going idle
+        if (idle)
+        {
+            head.reset();
+            tail.reset();
+            idle = false;
+
+            // Nothing was playing, so the head needn't wait for the tail
+            if (headWaiting)
+            {
+                head.setSpectra(activeIR->head.get());
+                headWaiting = false;
+            }
+        }
+
+        silentSamples = 0;
+    }
+    else
+    {
+        silentSamples += numSamples;
+        if (silentSamples > (juce::int64)(decayTime * sampleRate) + tail.getLatency() + numSamples)
+            idle = true;
+    }
+
+    if (idle)
+    {
+        buffer.clear();
+        return;
+    }
+
+    juce::AudioBuffer<float> tailOutput(tailBuffer.getArrayOfWritePointers(), juce::jmin(tailBuffer.getNumChannels(), buffer.getNumChannels()), numSamples);
+    tail.process(buffer, tailOutput);
+
+    if (profile == Profile::offline)
+    {
+        for (int channel = 0; channel < tailOutput.getNumChannels(); channel++)
+            buffer.copyFrom(channel, 0, tailOutput, channel, 0, numSamples);
+        return;
+    }
+
+    processHead(buffer);
+
+    for (int channel = 0; channel < tailOutput.getNumChannels(); channel++)
+        buffer.addFrom(channel, 0, tailOutput, channel, 0, numSamples);
+}
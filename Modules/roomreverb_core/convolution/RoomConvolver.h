@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <juce_dsp/juce_dsp.h>
+#include "HeadConvolver.h"
+#include "TailConvolver.h"
+
+/***************************************************************/
+// Convolves the plugin's audio with the current room IR.
+//
+// The start of the IR is convolved on the audio thread, see
+// HeadConvolver, the long tail by the process-wide
+// ConvolutionPool, see TailConvolver.
+//
+// New IRs can be loaded from any thread but the audio thread
+// while audio is running. Both halves are transformed by the
+// loading thread and staged for the audio thread, which starts
+// the head and tail fading from the old IR to the new one on the
+// same sample, over a tail partition, so the head and tail never
+// play different IRs.
+//
+// For offline renders, the whole IR is convolved by the
+// TailConvolver's offline mode instead, with more latency but
+// more throughput and precision.
+//
+// Once the input has been silent for longer than the IR takes to
+// decay, the convolver goes idle and does no work at all until
+// the next block with any input.
+/***************************************************************/
+class RoomConvolver
+{
+public:
+    enum class Profile
+    {
+        realtime,
+        offline
+    };
+
+    void prepare(const juce::dsp::ProcessSpec& spec, Profile profile = Profile::realtime);
+    void reset();
+
+    /** The latency of the prepared profile, in samples. */
+    int getLatency() const { return tail.getLatency(); }
+
+    /** Replaces the IR. The buffer holds the IR at the prepared sample rate, one channel per output channel.
+        Not to be called from the audio thread, except when prepared offline, where it takes effect from the next partition.
+        Nor while prepare() runs.
+    */
+    void loadImpulseResponse(juce::AudioBuffer<float>&& ir, double sampleRate);
+
+    void process(juce::AudioBuffer<float>& buffer);
+
+    /** How long the output rings on after the input stops, in seconds, see getDecayLength(). */
+    double getDecayTime() const { return decayTime; }
+
+    bool isIdle() const { return idle; }
+
+    static constexpr float DECAY_FLOOR_DB = -80.0f;       // level below which the IR counts as decayed
+    static constexpr float SILENCE_THRESHOLD_DB = -96.0f;  // input peak below which a block counts as silent
+
+private:
+    // The head and tail of one IR, made by the loading thread and swapped in together by the audio thread
+    struct StagedIR {
+        std::shared_ptr<const HeadConvolver::HeadSpectra> head;
+        std::shared_ptr<const TailConvolver::TailSpectra> tail;
+    };
+
+    void swapInPendingIR();
+    void processHead(juce::AudioBuffer<float>& buffer);
+
+    HeadConvolver head;
+    TailConvolver tail;
+    juce::AudioBuffer<float> tailBuffer;
+    double sampleRate = 0.0;
+    Profile profile = Profile::realtime;
+
+    // Every IR loaded that the audio thread may still hold, so it's never the one to free them (loading thread only)
+    std::vector<std::shared_ptr<const StagedIR>> loadedIRs;
+    std::shared_ptr<const StagedIR> pendingIR; // the latest loaded, published by the loading thread
+    std::atomic<bool> hasPendingIR{ false };
+    std::shared_ptr<const StagedIR> activeIR, fadingIR; // audio thread only
+    bool headWaiting = false;                           // for the tail to start playing activeIR (audio thread only)
+
+    std::atomic<double> decayTime{ 0.0 };
+    std::atomic<bool> idle{ false };
+    juce::int64 silentSamples = 0; // audio thread only
+};
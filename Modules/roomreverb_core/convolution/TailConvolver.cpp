@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "TailConvolver.h"
+
+TailConvolver::TailConvolver()
+{
+    for (auto& deadline : deadlines)
+        deadline = -1.0;
+    for (auto& used : slotSpectra)
+        used = nullptr;
+}
+
+TailConvolver::~TailConvolver()
+{
+    pool->removeTask(this);
+}
+
+/***************************************************************/
+// The pool gets a partition less the audio thread's block to do
+// the work in, so partitions are at least twice the block size.
+/***************************************************************/
+int TailConvolver::getPartitionSize(int maximumBlockSize)
+{
+    return juce::jmax(MIN_PARTITION_SIZE, juce::nextPowerOfTwo(2 * maximumBlockSize));
+}
+
+void TailConvolver::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    pool->removeTask(this);
+    offline = false;
+    allocate(spec, getPartitionSize((int)spec.maximumBlockSize));
+    pool->addTask(this);
+}
+
+/***************************************************************/
+// Offline there is no deadline to meet, so the partitions are
+// as large as gives the most throughput and run straight away,
+// and the pool isn't involved.
+/***************************************************************/
+void TailConvolver::prepareOffline(const juce::dsp::ProcessSpec& spec)
+{
+    pool->removeTask(this);
+    offline = true;
+    allocate(spec, OFFLINE_PARTITION_SIZE);
+}
+
+void TailConvolver::allocate(const juce::dsp::ProcessSpec& spec, int newPartitionSize)
+{
+    partitionSize = newPartitionSize;
+    numBins = partitionSize + 1;
+    numChannels = (int)spec.numChannels;
+    maximumBlockSize = (int)spec.maximumBlockSize;
+    sampleRate = spec.sampleRate;
+    fftOrder = juce::roundToInt(std::log2(2.0 * partitionSize));
+    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+    inputSlots.assign(NUM_SLOTS, juce::AudioBuffer<float>(numChannels, partitionSize));
+    outputSlots.assign(NUM_SLOTS, juce::AudioBuffer<float>(numChannels, partitionSize));
+    for (int slot = 0; slot < NUM_SLOTS; slot++)
+    {
+        inputSlots[(size_t)slot].clear();
+        outputSlots[(size_t)slot].clear();
+        deadlines[slot] = -1.0;
+        slotSpectra[slot] = nullptr;
+    }
+
+    history.assign((size_t)numChannels, std::vector<float>((size_t)partitionSize, 0.0f));
+    delayLine.assign((size_t)numChannels, {});
+    delayLineLength = delayLinePosition = 0;
+    fftBuffer.assign((size_t)(4 * partitionSize), 0.0f);
+    fadeBuffer.assign((size_t)partitionSize, 0.0f);
+    accumulator.assign((size_t)numBins, {});
+    preciseAccumulator.assign(offline ? (size_t)numBins : 0, {});
+
+    // Spectra of the old partition size are no use, the IR has to be set again
+    std::atomic_store(&spectra, std::shared_ptr<const TailSpectra>());
+    previousSpectra = nullptr;
+    playingSpectra = nullptr;
+    hasTail = false;
+
+    posted = completed = 0;
+    filling = 0;
+    lastPosted = playing = -1;
+    accepting = true;
+    position = 0;
+    resetRequested = false;
+}
+
+void TailConvolver::reset()
+{
+    position = 0;
+    lastPosted = playing = -1;
+    resetRequested = true;
+}
+
+std::shared_ptr<const TailConvolver::TailSpectra> TailConvolver::createSpectra(const juce::AudioBuffer<float>& ir) const
+{
+    int tailStart = getTailStart();
+    int tailLength = ir.getNumSamples() - tailStart;
+    if (partitionSize == 0 || tailLength <= 0 || ir.getNumChannels() == 0)
+        return nullptr;
+
+    auto newSpectra = std::make_shared<TailSpectra>();
+    newSpectra->numChannels = ir.getNumChannels();
+    newSpectra->numPartitions = (tailLength + partitionSize - 1) / partitionSize;
+    newSpectra->numBins = numBins;
+    newSpectra->bins.resize((size_t)newSpectra->numChannels * newSpectra->numPartitions * numBins);
+
+    // A transform of our own, as the pool may be using the other one
+    juce::dsp::FFT transform(fftOrder);
+    std::vector<float> buffer((size_t)(4 * partitionSize));
+    for (int channel = 0; channel < newSpectra->numChannels; channel++)
+    {
+        for (int partition = 0; partition < newSpectra->numPartitions; partition++)
+        {
+            // Each partition zero padded to the FFT size, for overlap-save
+            int start = partition * partitionSize;
+            int length = juce::jmin(partitionSize, tailLength - start);
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+            std::copy_n(ir.getReadPointer(channel, tailStart + start), length, buffer.begin());
+
+            transform.performRealOnlyForwardTransform(buffer.data(), true);
+            auto* bins = reinterpret_cast<const std::complex<float>*>(buffer.data());
+            std::copy_n(bins, numBins, newSpectra->bins.begin() + ((size_t)channel * newSpectra->numPartitions + partition) * numBins);
+        }
+    }
+
+    return newSpectra;
+}
+
+void TailConvolver::setSpectra(std::shared_ptr<const TailSpectra> newSpectra)
+{
+    jassert(newSpectra == nullptr || newSpectra->numBins == numBins);
+
+    hasTail = newSpectra != nullptr;
+    std::atomic_store(&spectra, std::move(newSpectra));
+}
+
+void TailConvolver::process(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output)
+{
+    output.clear();
+    spectraSwitchOffset = -1;
+    if (!hasTail || partitionSize == 0)
+        return;
+
+    int numSamples = input.getNumSamples();
+    int channels = juce::jmin(numChannels, input.getNumChannels(), output.getNumChannels());
+    for (int start = 0; start < numSamples;)
+    {
+        int count = juce::jmin(numSamples - start, partitionSize - position);
+
+        if (accepting)
+            for (int channel = 0; channel < channels; channel++)
+                inputSlots[(size_t)(filling % NUM_SLOTS)].copyFrom(channel, position, input, channel, start, count);
+
+        if (playing >= 0)
+            for (int channel = 0; channel < channels; channel++)
+                output.copyFrom(channel, start, outputSlots[(size_t)(playing % NUM_SLOTS)], channel, position, count);
+
+        start += count;
+        position += count;
+        if (position == partitionSize && partitionFinished())
+            spectraSwitchOffset = start;
+    }
+}
+
+/***************************************************************/
+// End of a partition on the audio thread: start playing the
+// output of the partition posted at the end of the previous one,
+// and post the one just collected. Returns true if the output
+// starting now fades to other spectra than it played before.
+/***************************************************************/
+bool TailConvolver::partitionFinished()
+{
+    position = 0;
+
+    if (offline)
+    {
+        posted.store(++filling, std::memory_order_release);
+        runNext();
+        playing = filling - 1;
+        return false;
+    }
+
+    playing = lastPosted;
+    if (playing >= 0 && completed.load(std::memory_order_acquire) <= playing)
+    {
+        pool->reportMissedDeadline();
+        playing = -1;
+    }
+
+    lastPosted = -1;
+    if (accepting)
+    {
+        // Its output is needed a partition from now, but the audio thread works a block ahead
+        deadlines[filling % NUM_SLOTS] = juce::Time::getMillisecondCounterHiRes() + 1000.0 * (partitionSize - maximumBlockSize) / sampleRate;
+        lastPosted = filling++;
+        posted.store(filling, std::memory_order_release);
+        pool->notifyWorkPosted();
+    }
+
+    // Only collect into a slot the pool has finished with. If it hasn't, the partition is lost.
+    accepting = filling - completed.load(std::memory_order_acquire) < NUM_SLOTS;
+    if (!accepting)
+        pool->reportMissedDeadline();
+
+    if (playing < 0 || slotSpectra[playing % NUM_SLOTS].load() == playingSpectra)
+        return false;
+
+    playingSpectra = slotSpectra[playing % NUM_SLOTS].load();
+    return true;
+}
+
+double TailConvolver::getNextDeadline() const
+{
+    auto next = completed.load();
+    if (next >= posted.load(std::memory_order_acquire))
+        return -1.0;
+
+    return deadlines[next % NUM_SLOTS].load();
+}
+
+/***************************************************************/
+// Convolve the oldest posted partition with the tail: transform
+// it into the delay line, multiply-accumulate the delay line
+// with the tail's partitions and transform back. When the tail
+// has changed since the previous partition, the output fades
+// from the old tail to the new one over the partition.
+/***************************************************************/
+void TailConvolver::runNext()
+{
+    juce::int64 sequence = completed.load();
+    auto slot = (size_t)(sequence % NUM_SLOTS);
+    auto current = std::atomic_load(&spectra);
+
+    if (resetRequested.exchange(false))
+    {
+        for (auto& channelHistory : history)
+            std::fill(channelHistory.begin(), channelHistory.end(), 0.0f);
+        for (auto& line : delayLine)
+            std::fill(line.begin(), line.end(), std::complex<float>());
+    }
+
+    // Keep the input history when a longer tail arrives
+    if (current != nullptr && current->numPartitions > delayLineLength)
+    {
+        int newLength = current->numPartitions;
+        for (auto& line : delayLine)
+        {
+            std::vector<std::complex<float>> grown((size_t)newLength * numBins);
+            for (int age = 0; age < delayLineLength; age++)
+                std::copy_n(line.begin() + (size_t)((delayLinePosition - age + delayLineLength) % delayLineLength) * numBins, numBins,
+                            grown.begin() + (size_t)((newLength - age) % newLength) * numBins);
+            line = std::move(grown);
+        }
+
+        delayLineLength = newLength;
+        delayLinePosition = 0;
+    }
+
+    if (delayLineLength > 0)
+        delayLinePosition = (delayLinePosition + 1) % delayLineLength;
+
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        // Overlap-save: the previous partition followed by this one
+        auto* input = inputSlots[slot].getReadPointer(channel);
+        std::copy(history[(size_t)channel].begin(), history[(size_t)channel].end(), fftBuffer.begin());
+        std::copy_n(input, partitionSize, fftBuffer.begin() + partitionSize);
+        std::copy_n(input, partitionSize, history[(size_t)channel].begin());
+
+        auto* output = outputSlots[slot].getWritePointer(channel);
+        if (delayLineLength == 0)
+        {
+            std::fill_n(output, partitionSize, 0.0f);
+            continue;
+        }
+
+        fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+        auto* bins = reinterpret_cast<const std::complex<float>*>(fftBuffer.data());
+        std::copy_n(bins, numBins, delayLine[(size_t)channel].begin() + (size_t)delayLinePosition * numBins);
+
+        if (current != nullptr && offline)
+            convolve(*current, channel, output, preciseAccumulator);
+        else if (current != nullptr)
+            convolve(*current, channel, output, accumulator);
+        else
+            std::fill_n(output, partitionSize, 0.0f);
+
+        // Offline, the first IR is in place before rendering starts, so there's nothing to fade in from
+        if (current != previousSpectra && !(offline && previousSpectra == nullptr))
+        {
+            if (previousSpectra != nullptr && offline)
+                convolve(*previousSpectra, channel, fadeBuffer.data(), preciseAccumulator);
+            else if (previousSpectra != nullptr)
+                convolve(*previousSpectra, channel, fadeBuffer.data(), accumulator);
+            else
+                std::fill(fadeBuffer.begin(), fadeBuffer.end(), 0.0f);
+
+            for (int i = 0; i < partitionSize; i++)
+            {
+                float fade = (i + 1.0f) / partitionSize;
+                output[i] = fadeBuffer[(size_t)i] + fade * (output[i] - fadeBuffer[(size_t)i]);
+            }
+        }
+    }
+
+    previousSpectra = current;
+    slotSpectra[slot] = current.get();
+    completed.store(sequence + 1, std::memory_order_release);
+}
+
+template <typename Sample>
+void TailConvolver::convolve(const TailSpectra& tail, int channel, float* output, std::vector<std::complex<Sample>>& sums)
+{
+    int irChannel = juce::jmin(channel, tail.numChannels - 1);
+    int numPartitions = juce::jmin(tail.numPartitions, delayLineLength);
+    std::fill(sums.begin(), sums.end(), std::complex<Sample>());
+
+    for (int age = 0; age < numPartitions; age++)
+    {
+        auto* x = delayLine[(size_t)channel].data() + (size_t)((delayLinePosition - age + delayLineLength) % delayLineLength) * numBins;
+        auto* h = tail.get(irChannel, age);
+        for (int bin = 0; bin < numBins; bin++)
+        {
+            // Written out, as std::complex multiplication checks for infinities
+            Sample xr = x[bin].real(), xi = x[bin].imag(), hr = h[bin].real(), hi = h[bin].imag();
+            sums[(size_t)bin] += std::complex<Sample>(xr * hr - xi * hi, xr * hi + xi * hr);
+        }
+    }
+
+    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    auto* bins = reinterpret_cast<std::complex<float>*>(fftBuffer.data());
+    for (int bin = 0; bin < numBins; bin++)
+        bins[bin] = std::complex<float>((float)sums[(size_t)bin].real(), (float)sums[(size_t)bin].imag());
+    fft->performRealOnlyInverseTransform(fftBuffer.data());
+
+    // The second half is the linear convolution, the first is wrapped around
+    std::copy_n(fftBuffer.begin() + partitionSize, partitionSize, output);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <vector>
+#include <juce_dsp/juce_dsp.h>
+#include "ConvolutionPool.h"
+
+/***************************************************************/
+// Convolves audio with the late part of an IR, from two
+// partitions in, on the ConvolutionPool.
+//
+// The audio thread only collects input a partition at a time
+// and plays back finished output. Each partition is convolved
+// in the background (uniformly partitioned overlap-save), and
+// has until the audio thread reaches its output, a partition
+// later, to finish. The first two partitions of the IR are left
+// to a low latency convolution on the audio thread.
+//
+// Prepared for offline rendering instead, it convolves the whole
+// IR inline on the audio thread, with large partitions and
+// double precision accumulation, a partition late.
+/***************************************************************/
+class TailConvolver : public ConvolutionTask
+{
+public:
+    // Partition spectra of the tail, [channel][partition][bin]
+    struct TailSpectra {
+        int numChannels = 0, numPartitions = 0, numBins = 0;
+        std::vector<std::complex<float>> bins;
+
+        const std::complex<float>* get(int channel, int partition) const { return bins.data() + ((size_t)channel * numPartitions + partition) * numBins; }
+    };
+
+    TailConvolver();
+    ~TailConvolver() override;
+
+    /** The partition size used for a given maximum block size. */
+    static int getPartitionSize(int maximumBlockSize);
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void prepareOffline(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    /** Where the tail starts in the IR, in samples. Earlier samples are ignored by setImpulseResponse(). */
+    int getTailStart() const { return offline ? 0 : 2 * partitionSize; }
+
+    /** The delay of the output behind the input, beyond the tail start. */
+    int getLatency() const { return offline ? partitionSize : 0; }
+
+    /** Replaces the IR, at the prepared sample rate, one channel per audio channel or one for all.
+        Not to be called from the audio thread, unless prepared offline where the audio thread does the convolving.
+    */
+    void setImpulseResponse(const juce::AudioBuffer<float>& ir) { setSpectra(createSpectra(ir)); }
+
+    /** Transforms the tail of an IR for setSpectra(), so it can be swapped in later. Returns nullptr if the IR has no tail. Not to be called from the audio thread. */
+    std::shared_ptr<const TailSpectra> createSpectra(const juce::AudioBuffer<float>& ir) const;
+
+    /** Swaps in spectra from createSpectra(), or nullptr for none. The next partition fades over to them. Safe on the audio thread. */
+    void setSpectra(std::shared_ptr<const TailSpectra> newSpectra);
+
+    /** Replaces the contents of output with the tail of the convolution of input, delayed by the tail start. */
+    void process(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output);
+
+    /** The spectra the output is playing, or fading to, and where in the last process() call that fade started, or -1. Audio thread only. */
+    const TailSpectra* getPlayingSpectra() const { return playingSpectra; }
+    int getSpectraSwitchOffset() const { return spectraSwitchOffset; }
+
+    double getNextDeadline() const override;
+    void runNext() override;
+
+private:
+    static const int NUM_SLOTS = 4; // partitions of input and output in flight between the audio thread and the pool
+    static const int MIN_PARTITION_SIZE = 2048;
+    static const int OFFLINE_PARTITION_SIZE = 16384;
+
+    void allocate(const juce::dsp::ProcessSpec& spec, int newPartitionSize);
+    bool partitionFinished();
+    template <typename Sample>
+    void convolve(const TailSpectra& spectra, int channel, float* output, std::vector<std::complex<Sample>>& sums);
+
+    juce::SharedResourcePointer<ConvolutionPool> pool;
+
+    int partitionSize = 0, numBins = 0, numChannels = 0, maximumBlockSize = 0, fftOrder = 0;
+    double sampleRate = 0.0;
+    bool offline = false;
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    std::shared_ptr<const TailSpectra> spectra;  // replaced by setImpulseResponse(), read by runNext()
+    std::atomic<bool> hasTail{ false };
+
+    // Shared between the audio thread and the pool, by sequence number of the partition
+    std::vector<juce::AudioBuffer<float>> inputSlots, outputSlots;
+    std::atomic<double> deadlines[NUM_SLOTS];
+    std::atomic<juce::int64> posted{ 0 }, completed{ 0 };
+    std::atomic<bool> resetRequested{ false };
+    std::atomic<const TailSpectra*> slotSpectra[NUM_SLOTS]; // what each partition was convolved with, only ever compared
+
+    // Audio thread only
+    juce::int64 filling = 0;     // sequence number of the partition being collected
+    juce::int64 lastPosted = -1; // sequence number of the partition posted at the end of the previous one, or -1
+    juce::int64 playing = -1;    // sequence number of the partition whose output is playing, or -1 for silence
+    bool accepting = true;    // false if the pool fell too far behind to take the partition being collected
+    int position = 0;         // within the partition
+    const TailSpectra* playingSpectra = nullptr;
+    int spectraSwitchOffset = -1;
+
+    // Pool only
+    std::vector<std::vector<float>> history;                     // previous input partition, by channel
+    std::vector<std::vector<std::complex<float>>> delayLine;     // input spectra, by channel, newest at delayLinePosition
+    int delayLineLength = 0, delayLinePosition = 0;
+    std::shared_ptr<const TailSpectra> previousSpectra;
+    std::vector<float> fftBuffer, fadeBuffer;
+    std::vector<std::complex<float>> accumulator;
+    std::vector<std::complex<double>> preciseAccumulator; // offline only
+};
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "RoomReverbCore.h"
+
+// A job queued on the caller's thread pool
+class RoomReverbCore::TraceTask : public juce::ThreadPoolJob
+{
+public:
+    TraceTask(RoomReverbCore& owner, std::shared_ptr<TraceJob> jobToRun)
+        : juce::ThreadPoolJob("RoomReverbCore"), core(owner), job(std::move(jobToRun)) {}
+
+    JobStatus runJob() override
+    {
+        if (job->isCancelled())
+            return jobHasFinished;
+
+        auto result = core.traceNow(*job);
+        if (result != nullptr && !job->isCancelled() && job->onComplete)
+            job->onComplete(result);
+
+        return jobHasFinished;
+    }
+
+    RoomReverbCore& core;
+    const std::shared_ptr<TraceJob> job;
+};
+
+RoomReverbCore::RoomReverbCore(juce::ThreadPool& pool) : RoomReverbCore(pool, Options()) {}
+
+RoomReverbCore::RoomReverbCore(juce::ThreadPool& pool, const Options& optionsIn) : threadPool(pool), options(optionsIn) {}
+
+RoomReverbCore::~RoomReverbCore()
+{
+    // Only this core's tasks: the pool may be running other work too
+    struct OwnTasks : public juce::ThreadPool::JobSelector
+    {
+        explicit OwnTasks(RoomReverbCore& owner) : core(owner) {}
+
+        bool isJobSuitable(juce::ThreadPoolJob* poolJob) override
+        {
+            auto* task = dynamic_cast<TraceTask*>(poolJob);
+            if (task == nullptr || &task->core != &core)
+                return false;
+
+            task->job->cancel(); // a running trace stops after its current batch of rays
+            return true;
+        }
+
+        RoomReverbCore& core;
+    };
+
+    OwnTasks ownTasks(*this);
+    threadPool.removeAllJobs(true, -1, &ownTasks);
+}
+
+std::shared_ptr<const SharedData> RoomReverbCore::prepareScene(const SharedData& scene)
+{
+    auto prepared = std::make_shared<SharedData>(scene);
+    prepared->geometry = SceneGeometry::build(*prepared);
+    return prepared;
+}
+
+void RoomReverbCore::trace(std::shared_ptr<TraceJob> job)
+{
+    jassert(job != nullptr && job->scene != nullptr && job->scene->geometry != nullptr); // see prepareScene()
+    threadPool.addJob(new TraceTask(*this, std::move(job)), true);
+}
+
+std::shared_ptr<const TraceResult> RoomReverbCore::traceNow(TraceJob& job, TraceStats* stats)
+{
+    auto tracer = acquireTracer();
+
+    double startTime = juce::Time::getMillisecondCounterHiRes();
+    if (!job.isStarted())
+        job.start();
+
+    auto result = tracer->tracer.run(job);
+
+    if (stats != nullptr)
+    {
+        stats->tracer = tracer->index;
+        stats->seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        stats->workspaceBytes = tracer->workspacePool.getSpareBytes();
+    }
+
+    releaseTracer(std::move(tracer));
+    return result;
+}
+
+juce::AudioBuffer<float> RoomReverbCore::renderIR(const SparseIR& ir, double sampleRate)
+{
+    juce::AudioBuffer<float> buffer(1, getImpulseResponseLength(ir, sampleRate));
+    buffer.clear();
+    renderImpulseResponse(ir, buffer, sampleRate);
+    return buffer;
+}
+
+std::unique_ptr<RoomReverbCore::Tracer> RoomReverbCore::acquireTracer()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (idleTracers.empty())
+        return std::make_unique<Tracer>(numTracers++, options);
+
+    auto tracer = std::move(idleTracers.back());
+    idleTracers.pop_back();
+    return tracer;
+}
+
+void RoomReverbCore::releaseTracer(std::unique_ptr<Tracer> tracer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    idleTracers.push_back(std::move(tracer));
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "../geometry/SharedData.h"
+#include "../ir/ImpulseResponse.h"
+#include "../tracing/ProcessReflections.h"
+#include "../tracing/TraceJob.h"
+#include "../tracing/TraceResult.h"
+
+/***************************************************************/
+// The engine for programs other than the plugin: a scene goes
+// in, the sparse IR of each sound source comes out.
+//
+// Traces run on a thread pool the caller owns, as many at once
+// as it has threads, or on the caller's own thread. Each running
+// trace gets a tracer and working memory of its own, kept for the
+// next trace up to Options::maxWorkspaceBytes, so a pool that
+// traces scene after scene doesn't allocate for every one.
+//
+// The plugin traces through TraceScheduler instead, which only
+// keeps the latest scene of each instance.
+/***************************************************************/
+class RoomReverbCore
+{
+public:
+    struct Options {
+        size_t maxWorkspaceBytes = std::numeric_limits<size_t>::max(); // working memory each tracer keeps between traces
+        bool useIRCache = false; // reuse and fill the plugin's IR cache on disk
+    };
+
+    // What one trace took, for callers that time the engine
+    struct TraceStats {
+        int tracer = 0;            // which of the core's tracers ran it, from 0
+        double seconds = 0.0;
+        size_t workspaceBytes = 0; // working memory the tracer kept afterwards
+    };
+
+    explicit RoomReverbCore(juce::ThreadPool& pool);
+    RoomReverbCore(juce::ThreadPool& pool, const Options& options);
+
+    /** Cancels the traces still queued or running on the pool, and waits for them. */
+    ~RoomReverbCore();
+
+    /** Returns a copy of the scene with its geometry built, ready to trace. */
+    static std::shared_ptr<const SharedData> prepareScene(const SharedData& scene);
+
+    /** Queues the job on the thread pool. Its onComplete is called on a pool thread, unless the job is cancelled first. */
+    void trace(std::shared_ptr<TraceJob> job);
+
+    /** Traces the job on the calling thread, and returns the result or nullptr if the job was cancelled.
+        Its onComplete isn't called. */
+    std::shared_ptr<const TraceResult> traceNow(TraceJob& job, TraceStats* stats = nullptr);
+
+    /** Renders a sparse IR as one channel of samples. */
+    static juce::AudioBuffer<float> renderIR(const SparseIR& ir, double sampleRate);
+
+private:
+    struct Tracer {
+        Tracer(int tracerIndex, const Options& options)
+            : index(tracerIndex), workspacePool(options.maxWorkspaceBytes), tracer(workspacePool, options.useIRCache) {}
+
+        const int index;
+        TraceWorkspacePool workspacePool;
+        ProcessReflections tracer;
+    };
+
+    class TraceTask;
+
+    std::unique_ptr<Tracer> acquireTracer();
+    void releaseTracer(std::unique_ptr<Tracer> tracer);
+
+    juce::ThreadPool& threadPool;
+    const Options options;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Tracer>> idleTracers;
+    int numTracers = 0;
+};
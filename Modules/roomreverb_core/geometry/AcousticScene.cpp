@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#include "AcousticScene.h"
+
+// Ignore hits closer than this, so a ray leaving a surface doesn't hit it again
+static const float MIN_HIT_DISTANCE = 1e-4f;
+
+void AcousticScene::clear()
+{
+    triangles.clear();
+    receivers.clear();
+    numSurfaces = 0;
+}
+
+void AcousticScene::addGeometry(const SceneGeometry& geometry)
+{
+    for (auto& source : geometry.triangles)
+    {
+        SceneTriangle triangle;
+        triangle.v0 = source.v0;
+        triangle.edge1 = source.v1 - source.v0;
+        triangle.edge2 = source.v2 - source.v0;
+        triangle.normal = (triangle.edge1 ^ triangle.edge2).normalised();
+        triangle.surface = numSurfaces + source.surface;
+        triangle.material = source.material;
+        triangles.push_back(triangle);
+    }
+
+    numSurfaces += geometry.numSurfaces;
+}
+
+int AcousticScene::addReceiver(Vector3<float> centre, Vector3<float> size)
+{
+    receivers.push_back({ centre - size * 0.5f, centre + size * 0.5f });
+    return (int)receivers.size() - 1;
+}
+
+bool AcousticScene::intersect(const Ray& ray, SceneHit& hit, std::vector<SceneHit>& receiverHits) const
+{
+    hit = SceneHit();
+    receiverHits.clear();
+
+    // Nearest surface
+    const float EPSILON = 1e-8f;
+    for (size_t l = 0; l < triangles.size(); l++)
+    {
+        const SceneTriangle& triangle = triangles[l];
+
+        // Standard Möller-Trumbore algorithm, with the edges precomputed
+        Vector3<float> h = ray.direction ^ triangle.edge2;
+        float a = triangle.edge1 * h;
+        if (a > -EPSILON && a < EPSILON)
+            continue; // This ray is parallel to this triangle.
+
+        float f = 1.0f / a;
+        Vector3<float> s = ray.origin - triangle.v0;
+        float u = f * (s * h);
+        if (u < 0.0f || u > 1.0f)
+            continue;
+
+        Vector3<float> q = s ^ triangle.edge1;
+        float v = f * (ray.direction * q);
+        if (v < 0.0f || u + v > 1.0f)
+            continue;
+
+        float t = f * (triangle.edge2 * q);
+        if (t > MIN_HIT_DISTANCE && t < hit.distance)
+        {
+            hit.type = HitType::surface;
+            hit.distance = t;
+            hit.normal = triangle.normal;
+            hit.surface = triangle.surface;
+            hit.material = triangle.material;
+        }
+    }
+
+    if (hit.type == HitType::surface)
+        hit.point = ray.origin + ray.direction * hit.distance;
+
+    // Receivers in front of that surface
+    for (size_t r = 0; r < receivers.size(); r++)
+    {
+        float t;
+        if (intersectReceiver(ray, receivers[r], t) && t < hit.distance)
+        {
+            SceneHit receiverHit;
+            receiverHit.type = HitType::receiver;
+            receiverHit.distance = t;
+            receiverHit.point = ray.origin + ray.direction * t;
+            receiverHit.surface = (int)r;
+            receiverHits.push_back(receiverHit);
+        }
+    }
+
+    return hit.type == HitType::surface;
+}
+
+// Slab test. Returns the distance at which the ray enters the box, or leaves it if the ray starts inside.
+bool AcousticScene::intersectReceiver(const Ray& ray, const Receiver& receiver, float& t) const
+{
+    float tEnter = -FLT_MAX, tExit = FLT_MAX;
+    const float origin[3] = { ray.origin.x, ray.origin.y, ray.origin.z };
+    const float direction[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+    const float boxMin[3] = { receiver.min.x, receiver.min.y, receiver.min.z };
+    const float boxMax[3] = { receiver.max.x, receiver.max.y, receiver.max.z };
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (direction[axis] == 0.0f)
+        {
+            if (origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis])
+                return false;
+            continue;
+        }
+
+        float inverse = 1.0f / direction[axis];
+        float t0 = (boxMin[axis] - origin[axis]) * inverse;
+        float t1 = (boxMax[axis] - origin[axis]) * inverse;
+        if (t0 > t1) std::swap(t0, t1);
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+    }
+
+    if (tExit < tEnter || tExit <= MIN_HIT_DISTANCE)
+        return false;
+
+    t = tEnter > MIN_HIT_DISTANCE ? tEnter : tExit;
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#pragma once
+#include <vector>
+#include <cfloat>
+#include "SceneGeometry.h"
+#include <juce_core/juce_core.h>
+
+struct Ray {
+    Vector3<float> origin, direction;
+};
+
+enum class HitType { none, surface, receiver };
+
+struct SceneHit {
+    HitType type = HitType::none;
+    float distance = FLT_MAX;
+    Vector3<float> point, normal;
+    int surface = -1;   // surface ID for surfaces, receiver index for receivers
+    int material = -1;  // material (texture) ID of the surface
+};
+
+/***************************************************************/
+// The geometry the tracer casts rays against: reflecting
+// surfaces (the room, and any obstacles in it) held as
+// world-space triangles, plus axis-aligned receiver boxes.
+//
+// Receivers are transparent, so a single traversal returns the
+// nearest surface together with every receiver the ray crosses
+// before reaching it. A receiver behind a surface is occluded
+// and not reported.
+/***************************************************************/
+class AcousticScene
+{
+public:
+    void clear();
+
+    /** Adds the world-space surfaces of a room, see SceneGeometry. */
+    void addGeometry(const SceneGeometry& geometry);
+
+    /** Adds an axis-aligned receiver box, returning its index. */
+    int addReceiver(Vector3<float> centre, Vector3<float> size);
+
+    /** Finds the nearest surface hit by the ray, and the receivers crossed before it.
+        Returns true if a surface was hit. */
+    bool intersect(const Ray& ray, SceneHit& hit, std::vector<SceneHit>& receiverHits) const;
+
+    int getNumSurfaces() const { return numSurfaces; }
+    int getNumReceivers() const { return (int)receivers.size(); }
+
+private:
+    struct SceneTriangle {
+        Vector3<float> v0, edge1, edge2, normal;
+        int surface, material;
+    };
+
+    struct Receiver {
+        Vector3<float> min, max;
+    };
+
+    bool intersectReceiver(const Ray& ray, const Receiver& receiver, float& t) const;
+
+    std::vector<SceneTriangle> triangles;
+    std::vector<Receiver> receivers;
+    int numSurfaces = 0;
+};
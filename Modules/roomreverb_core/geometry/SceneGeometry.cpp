@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "SceneGeometry.h"
+#include "SharedData.h"
+
+namespace
+{
+    // Each quad of the OpenGL vertex layout (position, texture, ID) is two triangles
+    const juce::uint32 quadIndices[6] = { 0, 1, 3, 1, 2, 3 };
+    const int floatsPerVertex = 6;
+    const int verticesPerQuad = 4;
+
+    void addQuads(SceneGeometry& geometry, const std::vector<float>& source)
+    {
+        auto position = [&source](size_t vertex) {
+            return Vector3<float>(source[vertex * floatsPerVertex], source[vertex * floatsPerVertex + 1], source[vertex * floatsPerVertex + 2]);
+        };
+        auto toWorld = [&geometry](Vector3<float> v) {
+            return Vector3<float>(v.x * geometry.roomSize.x + geometry.roomPos.x,
+                                  v.y * geometry.roomSize.y + geometry.roomPos.y,
+                                  v.z * geometry.roomSize.z + geometry.roomPos.z);
+        };
+        auto worldLength = [&geometry](Vector3<float> edge) {
+            return Vector3<float>(edge.x * geometry.roomSize.x, edge.y * geometry.roomSize.y, edge.z * geometry.roomSize.z).length();
+        };
+
+        size_t numQuads = source.size() / (floatsPerVertex * verticesPerQuad);
+        for (size_t quad = 0; quad < numQuads; quad++)
+        {
+            size_t first = quad * verticesPerQuad;
+            auto base = (juce::uint32)geometry.vertices.size();
+
+            // Texture coordinates run along the quad's first and second edges, and are scaled by their length in the room
+            float uScale = worldLength(position(first + 1) - position(first));
+            float vScale = worldLength(position(first + 2) - position(first + 1));
+
+            for (size_t vertex = first; vertex < first + verticesPerQuad; vertex++)
+            {
+                const float* v = source.data() + vertex * floatsPerVertex;
+                geometry.vertices.push_back({ { v[0], v[1], v[2] }, { v[3] * uScale, v[4] * vScale }, v[5] });
+            }
+
+            int material = (int)source[first * floatsPerVertex + 5];
+            for (int i = 0; i < 6; i += 3)
+            {
+                SceneGeometry::Triangle triangle;
+                triangle.v0 = toWorld(position(first + quadIndices[i]));
+                triangle.v1 = toWorld(position(first + quadIndices[i + 1]));
+                triangle.v2 = toWorld(position(first + quadIndices[i + 2]));
+                triangle.surface = geometry.numSurfaces;
+                triangle.material = material;
+                geometry.triangles.push_back(triangle);
+
+                for (int n = 0; n < 3; n++)
+                    geometry.indices.push_back(base + quadIndices[i + n]);
+            }
+
+            geometry.numSurfaces++;
+        }
+    }
+}
+
+std::shared_ptr<const SceneGeometry> SceneGeometry::build(const SharedData& scene)
+{
+    auto geometry = std::make_shared<SceneGeometry>();
+    geometry->roomPos = scene.roomPos;
+    geometry->roomSize = scene.roomSize;
+
+    // The tracer's surface IDs follow this order
+    addQuads(*geometry, scene.floor);
+    addQuads(*geometry, scene.walls);
+    addQuads(*geometry, scene.ceiling);
+    return geometry;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <memory>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "Vector3.h"
+
+struct SharedData;
+
+/***************************************************************/
+// The room's surfaces, built once per scene snapshot and used by
+// both the view and the tracer, so what is drawn is what is
+// heard.
+//
+// The render stream holds every surface in one interleaved
+// vertex buffer (model space, with the texture coordinates
+// scaled to the room so materials keep their size) and one index
+// buffer, so the room is drawn in a single call. The triangle
+// table holds the same triangles in world space, in index order,
+// with the surface and material of each, for the tracer.
+// Nothing here needs an OpenGL context.
+/***************************************************************/
+struct SceneGeometry {
+    // Same layout as the vertex attributes of RoomRender
+    struct Vertex {
+        float position[3];
+        float texCoord[2];
+        float material;
+    };
+
+    struct Triangle {
+        Vector3<float> v0, v1, v2;
+        int surface, material;
+    };
+
+    std::vector<Vertex> vertices;
+    std::vector<juce::uint32> indices;
+    std::vector<Triangle> triangles; // triangles[i] is indices[3 * i] to indices[3 * i + 2] in world space
+    int numSurfaces = 0;             // each surface is a quad of two triangles
+
+    // Model space to world space: position * roomSize + roomPos
+    Vector3<float> roomPos, roomSize;
+
+    /** Builds the geometry of the scene's room: floor, walls, then ceiling. */
+    static std::shared_ptr<const SceneGeometry> build(const SharedData& scene);
+};
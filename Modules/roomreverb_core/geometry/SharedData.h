@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "SceneGeometry.h"
+
+/***************************************************************/
+// The scene of one plugin instance: the room, listener and
+// sound sources, and the settings the tracer runs with.
+// Published as immutable snapshots by SharedDataState.
+/***************************************************************/
+struct SharedData
+{
+    juce::uint64 version = 0;
+
+    // The listener box is a twentieth of the room to help manage the processing overhead
+    Vector3<float> roomSize{ 20.0f, 20.0f, 20.0f }, roomPos{ 10.0f, 10.0f, 10.0f };
+    Vector3<float> listenerPos{ 2.0f, 2.0f, 2.0f }, listenerSize{ 1.0f, 1.0f, 1.0f };
+    std::vector<Vector3<float>> soundSourcePositions{ { 9.0f, 9.0f, 9.0f } };
+
+    float speedOfSound = 346.0f;
+    float rollOff = 1.0f;
+    float delayBucketSize = 1.0f / 44.1f; //ms
+    float refinementTolerance = 0.01f;
+    int additionalRays = 10;
+    int numberPolarBuckets = 20;
+    int maxRefinementRounds = 6;
+    int numReflections = 15; // not saved with the plugin state, only raised for offline renders, see getOfflineQuality()
+    int receiverGridX = 4, receiverGridY = 2, receiverGridZ = 4;
+
+    // Upper bounds of the settings above for scenes read from plugin state, cache files or
+    // batch manifests, so a damaged file can't ask the tracer for unbounded work or memory
+    struct Limits {
+        static constexpr int additionalRays = 1000;
+        static constexpr int numberPolarBuckets = 180;
+        static constexpr int maxRefinementRounds = 100;
+        static constexpr int numReflections = 200;
+        static constexpr int receiverGridSize = 32; // cells along each axis
+    };
+
+    std::vector<float> walls{
+        //Position            //Texture    //ID
+        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,  0.0f,
+         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,  0.0f,
+         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,  0.0f,
+        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,  0.0f,
+
+        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,  0.0f,
+         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,  0.0f,
+         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,  0.0f,
+        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,  0.0f,
+
+        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,  0.0f,
+        -0.5f,  0.5f, -0.5f,  1.0f, 0.0f,  0.0f,
+        -0.5f, -0.5f, -0.5f,  1.0f, 1.0f,  0.0f,
+        -0.5f, -0.5f,  0.5f,  0.0f, 1.0f,  0.0f,
+
+         0.5f,  0.5f,  0.5f,  0.0f, 0.0f,  0.0f,
+         0.5f,  0.5f, -0.5f,  1.0f, 0.0f,  0.0f,
+         0.5f, -0.5f, -0.5f,  1.0f, 1.0f,  0.0f,
+         0.5f, -0.5f,  0.5f,  0.0f, 1.0f,  0.0f,
+    };
+
+    std::vector<float> floor{
+        //Position            //Texture    //ID
+        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,  1.0f,
+         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,  1.0f,
+         0.5f, -0.5f,  0.5f,  1.0f, 1.0f,  1.0f,
+        -0.5f, -0.5f,  0.5f,  0.0f, 1.0f,  1.0f,
+    };
+
+    std::vector<float> ceiling{
+        //Position            //Texture    //ID
+        -0.5f,  0.5f, -0.5f,  0.0f, 0.0f,  2.0f,
+         0.5f,  0.5f, -0.5f,  1.0f, 0.0f,  2.0f,
+         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,  2.0f,
+        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,  2.0f,
+    };
+
+    // Built from the room above whenever a snapshot is published, see SharedDataState
+    std::shared_ptr<const SceneGeometry> geometry;
+};
+
+/***************************************************************/
+// The scene as traced for offline renders (bounces), where the
+// trace time matters less than the result: more refinement rays
+// and rounds, a tighter convergence test and twice the
+// reflections for a longer tail.
+/***************************************************************/
+inline SharedData getOfflineQuality(const SharedData& scene)
+{
+    SharedData offline(scene);
+    offline.additionalRays = 4 * scene.additionalRays;
+    offline.maxRefinementRounds = 2 * scene.maxRefinementRounds;
+    offline.refinementTolerance = scene.refinementTolerance / 4.0f;
+    offline.numReflections = 2 * scene.numReflections;
+    return offline;
+}
+
+/***************************************************************/
+// The box spanned by the cell centres of the receiver grid: the
+// room, less a listener box clear of each wall.
+/***************************************************************/
+inline void getReceiverGridBounds(const SharedData& scene, Vector3<float>& min, Vector3<float>& max)
+{
+    min = scene.roomPos - scene.roomSize * 0.5f + scene.listenerSize;
+    max = scene.roomPos + scene.roomSize * 0.5f - scene.listenerSize;
+}
+
+/** Returns where the listener sits in the receiver grid, as 0..1 on each axis like ReceiverGrid::getBlend() takes it. */
+inline Vector3<float> getListenerGridPosition(const SharedData& scene)
+{
+    Vector3<float> min, max;
+    getReceiverGridBounds(scene, min, max);
+
+    // A grid with no extent on an axis has its cells in the middle
+    auto along = [](float position, float lo, float hi) {
+        return hi > lo ? juce::jlimit(0.0f, 1.0f, (position - lo) / (hi - lo)) : 0.5f;
+    };
+
+    return { along(scene.listenerPos.x, min.x, max.x), along(scene.listenerPos.y, min.y, max.y), along(scene.listenerPos.z, min.z, max.z) };
+}
+
+/***************************************************************/
+// Holds the current SharedData snapshot of one plugin instance.
+// Readers take the snapshot and never block; writers change a
+// copy and publish it atomically, bumping its version.
+/***************************************************************/
+class SharedDataState
+{
+public:
+    std::shared_ptr<const SharedData> getSnapshot() const
+    {
+        return std::atomic_load(&snapshot);
+    }
+
+    void update(const std::function<void(SharedData&)>& change)
+    {
+        auto current = getSnapshot();
+        for (;;)
+        {
+            auto next = std::make_shared<SharedData>(*current);
+            change(*next);
+            next->version = current->version + 1;
+            next->geometry = SceneGeometry::build(*next);
+
+            // Retry on top of any snapshot published in the meantime
+            std::shared_ptr<const SharedData> published = std::move(next);
+            if (std::atomic_compare_exchange_weak(&snapshot, &current, published))
+                return;
+        }
+    }
+
+private:
+    static std::shared_ptr<const SharedData> createInitialSnapshot()
+    {
+        auto initial = std::make_shared<SharedData>();
+        initial->geometry = SceneGeometry::build(*initial);
+        return initial;
+    }
+
+    std::shared_ptr<const SharedData> snapshot = createInitialSnapshot();
+};
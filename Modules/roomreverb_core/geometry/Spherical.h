@@ -15,8 +15,6 @@
 #pragma once
 #include <cmath>
 
-using namespace std;
-
 /***************************************************************/
 // Helper to convert between Cartesian and Spherical coordinates
 /***************************************************************/
@@ -69,13 +67,13 @@ public:
 	Cartesian sph_to_car();
 };
 
-Spherical Cartesian::car_to_sph() {
+inline Spherical Cartesian::car_to_sph() {
 	Spherical temp;
 	float r, theta, phi;
 
-	temp.get_r() = (float)sqrt(pow(mx, 2) + pow(my, 2) + pow(mz, 2));
-	theta = atan2(my, mx) + juce::MathConstants<float>::pi;
-	phi = acos(mz / temp.get_r());
+	temp.get_r() = (float)std::sqrt(std::pow(mx, 2) + std::pow(my, 2) + std::pow(mz, 2));
+	theta = std::atan2(my, mx) + juce::MathConstants<float>::pi;
+	phi = std::acos(mz / temp.get_r());
 
 	temp.get_theta() = fmodf(theta, 2 * juce::MathConstants<float>::pi);
 	temp.get_phi() = fmodf(phi, juce::MathConstants<float>::pi);
@@ -83,16 +81,16 @@ Spherical Cartesian::car_to_sph() {
 	return temp;
 }
 
-Cartesian Spherical::sph_to_car() {
+inline Cartesian Spherical::sph_to_car() {
 	Cartesian temp;
 
 	mtheta -= juce::MathConstants<float>::pi;
 	mtheta = fmodf(mtheta, juce::MathConstants<float>::pi);
 	mphi = fmodf(mphi, juce::MathConstants<float>::pi);
 
-	temp.get_x() = mr * cos(mtheta) * sin(mphi);
-	temp.get_y() = mr * sin(mtheta) * sin(mphi);
-	temp.get_z() = mr * cos(mphi);
+	temp.get_x() = mr * std::cos(mtheta) * std::sin(mphi);
+	temp.get_y() = mr * std::sin(mtheta) * std::sin(mphi);
+	temp.get_z() = mr * std::cos(mphi);
 
 	return temp;
 }
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <cmath>
+
+/***************************************************************/
+// A 3D vector for the acoustic engine, with the same interface
+// and arithmetic as juce::Vector3D. That one lives in
+// juce_opengl, and the engine has to build without any GUI or
+// OpenGL modules (see roomreverb_core.h). The view converts to
+// juce::Vector3D where it needs matrices.
+/***************************************************************/
+template <typename Type>
+class Vector3
+{
+public:
+    Vector3() noexcept : x(), y(), z() {}
+    Vector3(Type xValue, Type yValue, Type zValue) noexcept : x(xValue), y(yValue), z(zValue) {}
+
+    Vector3& operator+=(Vector3 other) noexcept { x += other.x; y += other.y; z += other.z; return *this; }
+    Vector3& operator-=(Vector3 other) noexcept { x -= other.x; y -= other.y; z -= other.z; return *this; }
+    Vector3& operator*=(Type scale) noexcept { x *= scale; y *= scale; z *= scale; return *this; }
+    Vector3& operator/=(Type scale) noexcept { x /= scale; y /= scale; z /= scale; return *this; }
+
+    Vector3 operator+(Vector3 other) const noexcept { return { x + other.x, y + other.y, z + other.z }; }
+    Vector3 operator-(Vector3 other) const noexcept { return { x - other.x, y - other.y, z - other.z }; }
+    Vector3 operator*(Type scale) const noexcept { return { x * scale, y * scale, z * scale }; }
+    Vector3 operator/(Type scale) const noexcept { return { x / scale, y / scale, z / scale }; }
+    Vector3 operator-() const noexcept { return { -x, -y, -z }; }
+
+    /** Dot product. */
+    Type operator*(Vector3 other) const noexcept { return x * other.x + y * other.y + z * other.z; }
+
+    /** Cross product. */
+    Vector3 operator^(Vector3 other) const noexcept { return { y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x }; }
+
+    Type length() const noexcept { return std::sqrt(lengthSquared()); }
+    Type lengthSquared() const noexcept { return x * x + y * y + z * z; }
+    Vector3 normalised() const noexcept { return *this / length(); }
+
+    bool operator==(Vector3 other) const noexcept { return x == other.x && y == other.y && z == other.z; }
+    bool operator!=(Vector3 other) const noexcept { return !operator==(other); }
+
+    Type x, y, z;
+};
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "IRExport.h"
+
+namespace
+{
+    const float HEAD_RADIUS = 0.0875f;    // m
+    const float SPEED_OF_SOUND = 343.0f;  // m/s, around the head
+    const float MAX_LEVEL_DIFFERENCE = 6.0f; // dB, far ear with the sound straight to the side
+
+    // Where one tap lands in each channel
+    struct TapPanning {
+        float gains[4];
+        int offsets[4]; // samples after the tap's own delay
+    };
+
+    int getMaxOffset(IRExportSettings::Layout layout, double sampleRate)
+    {
+        if (layout != IRExportSettings::Layout::binaural)
+            return 0;
+
+        float maxDelay = HEAD_RADIUS / SPEED_OF_SOUND * (juce::MathConstants<float>::halfPi + 1.0f);
+        return (int)std::ceil(maxDelay * sampleRate) + 1;
+    }
+
+    /***************************************************************/
+    // The taps carry the direction the sound was travelling in when
+    // it reached the receiver, as the azimuth and polar angle buckets
+    // the tracer sorted them into (see ProcessReflections::addTap).
+    // Turn them back into the direction it arrives from, then pan.
+    /***************************************************************/
+    TapPanning panTap(const ImpulseTap& tap, const IRExportSettings& settings)
+    {
+        TapPanning panning{};
+        for (int channel = 0; channel < 4; channel++)
+            panning.gains[channel] = tap.gain;
+
+        if (settings.layout == IRExportSettings::Layout::mono || settings.layout == IRExportSettings::Layout::stereo)
+            return panning;
+
+        float bucketSize = juce::MathConstants<float>::pi / (float)juce::jmax(1, settings.directionBuckets);
+        float theta = (tap.azimuth - 0.5f) * bucketSize;
+        float phi = juce::jlimit(0.0f, juce::MathConstants<float>::pi, (tap.elevation - 0.5f) * bucketSize);
+
+        // Arrival direction in the listener's frame
+        float right = std::sin(phi) * std::cos(theta);
+        float up = std::cos(phi);
+        float front = std::sin(phi) * std::sin(theta);
+
+        if (settings.layout == IRExportSettings::Layout::ambisonic)
+        {
+            panning.gains[1] *= -right; // Y, positive to the left
+            panning.gains[2] *= up;     // Z
+            panning.gains[3] *= front;  // X
+            return panning;
+        }
+
+        // Woodworth's interaural time difference, and a level difference growing towards the side
+        float lateral = std::asin(juce::jlimit(-1.0f, 1.0f, right));
+        float delay = HEAD_RADIUS / SPEED_OF_SOUND * (std::abs(lateral) + std::abs(right));
+        int farEar = right > 0.0f ? 0 : 1;
+        panning.gains[farEar] *= juce::Decibels::decibelsToGain(-MAX_LEVEL_DIFFERENCE * std::abs(right));
+        panning.offsets[farEar] = juce::roundToInt(delay * settings.sampleRate);
+        return panning;
+    }
+
+    std::unique_ptr<juce::AudioFormat> createFormat(IRExportSettings::Format format)
+    {
+        if (format == IRExportSettings::Format::flac)
+            return std::make_unique<juce::FlacAudioFormat>();
+        return std::make_unique<juce::WavAudioFormat>();
+    }
+}
+
+int IRExportSettings::getNumChannels() const
+{
+    switch (layout)
+    {
+    case Layout::mono:      return 1;
+    case Layout::ambisonic: return 4;
+    default:                return 2;
+    }
+}
+
+juce::File IRExportSettings::getSourceFile(int source) const
+{
+    if (source == 0)
+        return file;
+    return file.getSiblingFile(file.getFileNameWithoutExtension() + "-" + juce::String(source + 1) + file.getFileExtension());
+}
+
+IRExporter::IRExporter() : writer(*this)
+{
+    writer.startThread();
+}
+
+IRExporter::~IRExporter()
+{
+    // The writer finishes the queue before it exits
+    writer.signalThreadShouldExit();
+    writer.notify();
+    writer.stopThread(-1);
+}
+
+void IRExporter::exportIR(std::shared_ptr<const TraceResult> result, int source, const IRExportSettings& settings, Callback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back({ std::move(result), source, settings, std::move(callback) });
+    }
+    writer.notify();
+}
+
+int IRExporter::getNumPending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)queue.size() + numRunning;
+}
+
+void IRExporter::Writer::run()
+{
+    for (;;)
+    {
+        Request request;
+        bool haveRequest = false;
+        {
+            std::lock_guard<std::mutex> lock(exporter.mutex);
+            if (!exporter.queue.empty())
+            {
+                request = std::move(exporter.queue.front());
+                exporter.queue.pop_front();
+                exporter.numRunning = 1;
+                haveRequest = true;
+            }
+        }
+
+        if (!haveRequest)
+        {
+            if (threadShouldExit())
+                return;
+            wait(-1);
+            continue;
+        }
+
+        juce::String error;
+        if (request.result == nullptr || request.source < 0 || request.source >= (int)request.result->sources.size())
+            error = "There is no IR to export";
+        else
+            writeIR(request.result->sources[(size_t)request.source].listenerIR, request.settings, error);
+
+        if (request.callback != nullptr)
+            request.callback(request.settings.file, error);
+
+        std::lock_guard<std::mutex> lock(exporter.mutex);
+        exporter.numRunning = 0;
+    }
+}
+
+/***************************************************************/
+// The taps are sorted by delay, so each block only needs the taps
+// starting in it. Panning can push a tap up to maxOffset samples
+// later, into the next block, so the block buffer is that much
+// longer and its overhang is carried over to the next block.
+/***************************************************************/
+bool IRExporter::writeIR(const SparseIR& ir, const IRExportSettings& settings, juce::String& error)
+{
+    if (ir.empty())
+    {
+        error = "The IR is empty";
+        return false;
+    }
+
+    if (settings.sampleRate <= 0.0)
+    {
+        error = "Invalid sample rate";
+        return false;
+    }
+
+    auto format = createFormat(settings.format);
+    int numChannels = settings.getNumChannels();
+    int bitsPerSample = settings.format == IRExportSettings::Format::wavFloat ? 32 : 24;
+
+    settings.file.getParentDirectory().createDirectory();
+    settings.file.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream(settings.file.createOutputStream());
+    if (stream == nullptr)
+    {
+        error = "Can't write " + settings.file.getFullPathName();
+        return false;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), settings.sampleRate, (unsigned int)numChannels,
+        bitsPerSample, {}, 0));
+    if (writer == nullptr)
+    {
+        stream.reset();
+        settings.file.deleteFile();
+        error = format->getFormatName() + " can't hold this IR";
+        return false;
+    }
+    stream.release(); // owned by the writer
+
+    int maxOffset = getMaxOffset(settings.layout, settings.sampleRate);
+    int length = getImpulseResponseLength(ir, settings.sampleRate) + maxOffset;
+    juce::AudioBuffer<float> block(numChannels, BLOCK_SIZE + maxOffset);
+    block.clear();
+
+    size_t tap = 0;
+    for (int blockStart = 0; blockStart < length; blockStart += BLOCK_SIZE)
+    {
+        for (; tap < ir.size(); tap++)
+        {
+            int position = (int)(ir[tap].delay * settings.sampleRate / 1000.0) - blockStart;
+            if (position >= BLOCK_SIZE)
+                break;
+
+            TapPanning panning = panTap(ir[tap], settings);
+            for (int channel = 0; channel < numChannels; channel++)
+                block.addSample(channel, position + panning.offsets[channel], panning.gains[channel]);
+        }
+
+        int numSamples = juce::jmin(BLOCK_SIZE, length - blockStart);
+        if (!writer->writeFromAudioSampleBuffer(block, 0, numSamples))
+        {
+            writer.reset();
+            settings.file.deleteFile();
+            error = "Can't write " + settings.file.getFullPathName();
+            return false;
+        }
+
+        for (int channel = 0; channel < numChannels; channel++)
+        {
+            block.copyFrom(channel, 0, block, channel, BLOCK_SIZE, maxOffset);
+            block.clear(channel, maxOffset, BLOCK_SIZE);
+        }
+    }
+
+    // Closing the writer finishes the file's header
+    writer.reset();
+    return true;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "ImpulseResponse.h"
+#include "../tracing/TraceResult.h"
+
+// How an IR is written out, see IRExporter
+struct IRExportSettings {
+    enum class Format {
+        wavFloat, // 32-bit float WAV
+        wav24,    // 24-bit integer WAV
+        flac      // 24-bit FLAC
+    };
+
+    enum class Layout {
+        mono,
+        stereo,   // the same IR in both channels, as the convolver hears it
+        binaural, // left and right ears of a spherical head: interaural time and level differences, no HRTF filtering
+        ambisonic // first order AmbiX: W, Y, Z, X (ACN order, SN3D normalisation)
+    };
+
+    juce::File file;
+    Format format = Format::wavFloat;
+    Layout layout = Layout::stereo;
+    double sampleRate = 48000.0;
+    int directionBuckets = 20; // SharedData::numberPolarBuckets of the traced scene, to turn the taps' direction buckets back into angles
+
+    int getNumChannels() const;
+
+    /** The file for one source of a result: the first source goes to file, the others next to it, numbered from 2. */
+    juce::File getSourceFile(int source) const;
+};
+
+/***************************************************************/
+// Writes traced IRs to audio files on a background thread.
+//
+// IRs are rendered from their taps a block at a time and each
+// block is written as soon as it is ready, so an export only
+// holds one block of audio, however long the IR or high the
+// sample rate. Directions are relative to a listener facing -z
+// with +y up, as the room is modelled.
+/***************************************************************/
+class IRExporter
+{
+public:
+    /** Called on the export thread when an export has finished, with an empty error if it succeeded. */
+    using Callback = std::function<void(const juce::File& file, const juce::String& error)>;
+
+    IRExporter();
+
+    /** Finishes the queued exports. */
+    ~IRExporter();
+
+    /** Queues an export of the listener IR of one source of a result. */
+    void exportIR(std::shared_ptr<const TraceResult> result, int source, const IRExportSettings& settings, Callback callback = nullptr);
+
+    /** Returns the number of exports queued or running. */
+    int getNumPending() const;
+
+    /** Writes an IR straight away on the calling thread. Returns false, and why, if the file couldn't be written. */
+    static bool writeIR(const SparseIR& ir, const IRExportSettings& settings, juce::String& error);
+
+private:
+    struct Request {
+        std::shared_ptr<const TraceResult> result;
+        int source = 0;
+        IRExportSettings settings;
+        Callback callback;
+    };
+
+    class Writer : public juce::Thread
+    {
+    public:
+        explicit Writer(IRExporter& owner) : juce::Thread("IRExporter"), exporter(owner) {}
+        void run() override;
+
+    private:
+        IRExporter& exporter;
+    };
+
+    static const int BLOCK_SIZE = 8192; // samples rendered and written at a time
+
+    mutable std::mutex mutex;
+    std::deque<Request> queue;
+    int numRunning = 0;
+    Writer writer;
+};
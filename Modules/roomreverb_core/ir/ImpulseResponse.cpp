@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#include "ImpulseResponse.h"
+
+int getImpulseResponseLength(const SparseIR& ir, double sampleRate)
+{
+    if (ir.empty())
+        return 0;
+
+    return (int)(ir.back().delay * sampleRate / 1000.0) + 1;
+}
+
+void renderImpulseResponse(const ImpulseTap* taps, int numTaps, juce::AudioBuffer<float>& buffer, double sampleRate, float gain)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        for (int i = 0; i < numTaps; ++i)
+        {
+            int samplePos = (int)(taps[i].delay * sampleRate / 1000.0);
+            if (samplePos >= buffer.getNumSamples())
+                break;
+
+            buffer.addSample(channel, samplePos, taps[i].gain * gain);
+        }
+    }
+}
+
+void renderImpulseResponse(const SparseIR& ir, juce::AudioBuffer<float>& buffer, double sampleRate, float gain)
+{
+    renderImpulseResponse(ir.data(), (int)ir.size(), buffer, sampleRate, gain);
+}
+
+std::vector<double> getRemainingEnergy(const juce::AudioBuffer<float>& ir)
+{
+    std::vector<double> remaining((size_t)ir.getNumSamples());
+    double energy = 0.0;
+    for (int i = ir.getNumSamples() - 1; i >= 0; --i)
+    {
+        for (int channel = 0; channel < ir.getNumChannels(); ++channel)
+            energy += (double)ir.getSample(channel, i) * ir.getSample(channel, i);
+
+        remaining[(size_t)i] = energy;
+    }
+
+    return remaining;
+}
+
+int getDecayLength(const juce::AudioBuffer<float>& ir, float floorDb)
+{
+    auto remaining = getRemainingEnergy(ir);
+    if (remaining.empty())
+        return 0;
+
+    // The last sample where the energy still to come is above the floor
+    double floor = remaining.front() * std::pow(10.0, floorDb / 10.0);
+    for (int i = (int)remaining.size() - 1; i >= 0; --i)
+        if (remaining[(size_t)i] > floor)
+            return i + 1;
+
+    return 0;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#pragma once
+#include <vector>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+// One reflection arriving at a receiver
+struct ImpulseTap {
+    float delay;               // ms
+    float azimuth, elevation;  // direction buckets
+    float gain;
+};
+
+// An impulse response as the list of reflections making it up, sorted by delay
+using SparseIR = std::vector<ImpulseTap>;
+
+/** Returns the number of samples needed to hold the rendered IR. */
+int getImpulseResponseLength(const SparseIR& ir, double sampleRate);
+
+/** Adds the taps of the IR, scaled by gain, into every channel of buffer. Taps past the end of the buffer are dropped. */
+void renderImpulseResponse(const ImpulseTap* taps, int numTaps, juce::AudioBuffer<float>& buffer, double sampleRate, float gain = 1.0f);
+void renderImpulseResponse(const SparseIR& ir, juce::AudioBuffer<float>& buffer, double sampleRate, float gain = 1.0f);
+
+/** Returns the energy left in the rendered IR from each sample to its end, over all channels (Schroeder backward integration).
+    The first value is the IR's total energy. */
+std::vector<double> getRemainingEnergy(const juce::AudioBuffer<float>& ir);
+
+/** Returns the number of samples after which the energy left in the rendered IR is floorDb below its total, see getRemainingEnergy(). */
+int getDecayLength(const juce::AudioBuffer<float>& ir, float floorDb);
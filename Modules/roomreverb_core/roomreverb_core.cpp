@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#ifdef ROOMREVERB_CORE_H_INCLUDED
+ /* This file is the module's single translation unit: add it to a
+    project on its own (the Projucer does), not after other headers. */
+ #error "Incorrect use of the roomreverb_core cpp file"
+#endif
+
+#include "roomreverb_core.h"
+
+// For the ConvolutionPool's semaphore
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <cerrno>
+ #include <semaphore.h>
+#endif
+
+#include "geometry/SceneGeometry.cpp"
+#include "geometry/AcousticScene.cpp"
+
+#include "ir/ImpulseResponse.cpp"
+
+#include "tracing/ReceiverGrid.cpp"
+#include "tracing/TraceResult.cpp"
+#include "tracing/RayPaths.cpp"
+#include "tracing/TraceLog.cpp"
+#include "tracing/IRCache.cpp"
+#include "tracing/IRStore.cpp"
+#include "tracing/ProcessReflections.cpp"
+
+#include "ir/IRExport.cpp"
+
+#include "convolution/ConvolutionPool.cpp"
+#include "convolution/HeadConvolver.cpp"
+#include "convolution/TailConvolver.cpp"
+#include "convolution/RoomConvolver.cpp"
+
+#include "verify/IRComparison.cpp"
+#include "verify/ImageSource.cpp"
+#include "verify/GoldenIR.cpp"
+
+#include "core/RoomReverbCore.cpp"
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+/*******************************************************************************
+ The block below describes the properties of this module, and is read by
+ the Projucer to automatically generate project code that uses it.
+
+ BEGIN_JUCE_MODULE_DECLARATION
+
+  ID:                 roomreverb_core
+  vendor:             jgstanier
+  version:            1.0.0
+  name:               Room Reverb core
+  description:        The acoustic engine of the Room Reverb plugin: scene geometry, ray tracing, IR assembly and export, and convolution.
+  license:            GPLv3 / commercial
+  minimumCppStandard: 17
+
+  dependencies:       juce_core, juce_audio_basics, juce_audio_formats, juce_dsp
+
+ END_JUCE_MODULE_DECLARATION
+
+*******************************************************************************/
+
+#pragma once
+#define ROOMREVERB_CORE_H_INCLUDED
+
+/***************************************************************/
+// The acoustic engine, shared by the plugin and the command line
+// renderer, and the checks it is verified with. Nothing in here
+// needs a host, a message thread, a GUI or OpenGL, so it links
+// into any program with the four JUCE modules above.
+// RoomReverbCore is the entry point for programs other than the
+// plugin.
+/***************************************************************/
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "geometry/Vector3.h"
+#include "geometry/SceneGeometry.h"
+#include "geometry/SharedData.h"
+#include "geometry/AcousticScene.h"
+
+#include "ir/ImpulseResponse.h"
+
+#include "tracing/PathSignature.h"
+#include "tracing/ReceiverGrid.h"
+#include "tracing/TraceResult.h"
+#include "tracing/RayPaths.h"
+#include "tracing/TraceJob.h"
+#include "tracing/TraceLogFormat.h"
+#include "tracing/TraceLog.h"
+#include "tracing/IRCache.h"
+#include "tracing/IRStore.h"
+#include "tracing/ProcessReflections.h"
+
+#include "ir/IRExport.h"
+
+#include "convolution/ConvolutionPool.h"
+#include "convolution/HeadConvolver.h"
+#include "convolution/TailConvolver.h"
+#include "convolution/RoomConvolver.h"
+
+#include "verify/IRComparison.h"
+#include "verify/ImageSource.h"
+#include "verify/GoldenIR.h"
+
+#include "core/RoomReverbCore.h"
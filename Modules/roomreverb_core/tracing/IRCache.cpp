@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "IRCache.h"
+
+namespace
+{
+    const char entryMagic[4] = { 'R', 'R', 'I', 'R' };
+    const juce::uint32 entryFormatVersion = 1;
+    const char* entryExtension = ".rrir";
+
+    // FNV-1a over the raw bytes of each field
+    struct SceneHasher
+    {
+        juce::uint64 hash = 14695981039346656037ULL;
+
+        void addBytes(const void* data, size_t size)
+        {
+            auto* bytes = static_cast<const juce::uint8*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        template <typename T>
+        void add(const T& value) { addBytes(&value, sizeof(T)); }
+
+        void add(Vector3<float> v) { add(v.x); add(v.y); add(v.z); }
+
+        template <typename T>
+        void add(const std::vector<T>& values)
+        {
+            add((juce::uint64)values.size());
+            for (auto& value : values)
+                add(value);
+        }
+    };
+}
+
+IRCache::IRCache() : IRCache(getDefaultDirectory(), (juce::int64)256 * 1024 * 1024) {}
+
+IRCache::IRCache(const juce::File& directoryIn, juce::int64 maxSizeBytes)
+    : directory(directoryIn), maxSize(maxSizeBytes)
+{
+}
+
+juce::File IRCache::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("RoomReverb")
+        .getChildFile("IRCache");
+}
+
+juce::uint64 IRCache::hashScene(const SharedData& scene, int engineVersion)
+{
+    // The snapshot version is left out: it changes on every edit, even one that is later undone
+    SceneHasher hasher;
+    hasher.add(engineVersion);
+    hasher.add(scene.roomSize);
+    hasher.add(scene.roomPos);
+    hasher.add(scene.listenerPos);
+    hasher.add(scene.listenerSize);
+    hasher.add((juce::uint64)scene.soundSourcePositions.size());
+    for (auto& position : scene.soundSourcePositions)
+        hasher.add(position);
+    hasher.add(scene.speedOfSound);
+    hasher.add(scene.rollOff);
+    hasher.add(scene.delayBucketSize);
+    hasher.add(scene.refinementTolerance);
+    hasher.add(scene.additionalRays);
+    hasher.add(scene.numberPolarBuckets);
+    hasher.add(scene.maxRefinementRounds);
+    hasher.add(scene.numReflections);
+    hasher.add(scene.receiverGridX);
+    hasher.add(scene.receiverGridY);
+    hasher.add(scene.receiverGridZ);
+    hasher.add(scene.walls);
+    hasher.add(scene.floor);
+    hasher.add(scene.ceiling);
+    return hasher.hash;
+}
+
+juce::File IRCache::getEntryFile(juce::uint64 sceneHash) const
+{
+    return directory.getChildFile(juce::String::toHexString((juce::int64)sceneHash).paddedLeft('0', 16) + entryExtension);
+}
+
+std::shared_ptr<TraceResult> IRCache::load(juce::uint64 sceneHash)
+{
+    juce::File file = getEntryFile(sceneHash);
+    if (!file.existsAsFile())
+        return nullptr;
+
+    juce::MemoryMappedFile mappedFile(file, juce::MemoryMappedFile::readOnly);
+    if (mappedFile.getData() == nullptr)
+        return nullptr;
+
+    // Header: magic, format version, scene hash
+    const size_t headerSize = sizeof(entryMagic) + sizeof(juce::uint32) + sizeof(juce::uint64);
+    auto* data = static_cast<const char*>(mappedFile.getData());
+    juce::uint32 formatVersion;
+    juce::uint64 entryHash;
+    if (mappedFile.getSize() < headerSize || memcmp(data, entryMagic, sizeof(entryMagic)) != 0)
+        return nullptr;
+
+    memcpy(&formatVersion, data + sizeof(entryMagic), sizeof(formatVersion));
+    memcpy(&entryHash, data + sizeof(entryMagic) + sizeof(formatVersion), sizeof(entryHash));
+    if (formatVersion != entryFormatVersion || entryHash != sceneHash)
+        return nullptr;
+
+    auto result = readTraceResult(data + headerSize, mappedFile.getSize() - headerSize);
+    if (result == nullptr)
+        return nullptr;
+
+    result->sceneHash = sceneHash;
+
+    // Mark the entry as recently used
+    file.setLastModificationTime(juce::Time::getCurrentTime());
+    return result;
+}
+
+bool IRCache::store(juce::uint64 sceneHash, const TraceResult& result)
+{
+    if (!directory.createDirectory())
+        return false;
+
+    juce::MemoryOutputStream stream;
+    stream.write(entryMagic, sizeof(entryMagic));
+    stream.write(&entryFormatVersion, sizeof(entryFormatVersion));
+    stream.write(&sceneHash, sizeof(sceneHash));
+    writeTraceResult(stream, result);
+
+    // Write to a temporary file first, so a concurrent load never sees half an entry
+    juce::TemporaryFile temporaryFile(getEntryFile(sceneHash));
+    if (!temporaryFile.getFile().replaceWithData(stream.getData(), stream.getDataSize())
+        || !temporaryFile.overwriteTargetFileWithTemporary())
+        return false;
+
+    evict();
+    return true;
+}
+
+void IRCache::evict()
+{
+    auto entries = directory.findChildFiles(juce::File::findFiles, false, juce::String("*") + entryExtension);
+
+    // Most recently used first
+    std::vector<std::pair<juce::int64, juce::File>> entriesByTime;
+    for (auto& entry : entries)
+        entriesByTime.emplace_back(entry.getLastModificationTime().toMilliseconds(), entry);
+    std::sort(entriesByTime.begin(), entriesByTime.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    juce::int64 totalSize = 0;
+    for (auto& entry : entriesByTime)
+    {
+        totalSize += entry.second.getSize();
+        if (totalSize > maxSize)
+            entry.second.deleteFile();
+    }
+}
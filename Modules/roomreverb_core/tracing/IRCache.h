@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <memory>
+#include <juce_core/juce_core.h>
+#include "../geometry/SharedData.h"
+#include "TraceResult.h"
+
+/***************************************************************/
+// Persistent cache of trace results, one file per scene.
+//
+// Entries are keyed by a stable hash of everything that affects
+// the trace, so an unchanged room (in this session or an earlier
+// one) loads in milliseconds instead of being retraced. Files
+// are a compact binary dump of the sparse taps, memory-mapped
+// when loaded. The least recently used entries are deleted once
+// the cache grows past its size limit.
+/***************************************************************/
+class IRCache
+{
+public:
+    IRCache();
+    IRCache(const juce::File& directory, juce::int64 maxSizeBytes);
+
+    /** Returns the cache location shared by every instance of the plugin. */
+    static juce::File getDefaultDirectory();
+
+    /** Hashes the parts of the scene the trace depends on, together with the engine version. */
+    static juce::uint64 hashScene(const SharedData& scene, int engineVersion);
+
+    /** Returns the cached result for the scene, or nullptr if there is none or it can't be read. */
+    std::shared_ptr<TraceResult> load(juce::uint64 sceneHash);
+
+    /** Writes the result for the scene, then trims the cache back to its size limit. */
+    bool store(juce::uint64 sceneHash, const TraceResult& result);
+
+private:
+    juce::File getEntryFile(juce::uint64 sceneHash) const;
+    void evict();
+
+    juce::File directory;
+    juce::int64 maxSize;
+};
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "IRStore.h"
+
+std::shared_ptr<const TraceResult> IRStore::find(juce::uint64 sceneHash)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto entry = results.find(sceneHash);
+    return entry != results.end() ? entry->second.lock() : nullptr;
+}
+
+std::shared_ptr<const TraceResult> IRStore::add(std::shared_ptr<const TraceResult> result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Forget the results nobody holds any more
+    for (auto entry = results.begin(); entry != results.end();)
+    {
+        if (entry->second.expired())
+            entry = results.erase(entry);
+        else
+            ++entry;
+    }
+
+    auto& stored = results[result->sceneHash];
+    if (auto existing = stored.lock())
+        return existing;
+
+    stored = result;
+    return result;
+}
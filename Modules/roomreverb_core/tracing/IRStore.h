@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <juce_core/juce_core.h>
+#include "TraceResult.h"
+
+/***************************************************************/
+// The trace results held in memory by every plugin instance in
+// the process, keyed by scene hash.
+//
+// Instances on the same room share one read-only copy of its
+// IRs, however they got them (traced, from the IRCache or from
+// the plugin state). The store only keeps weak references, so a
+// result is freed once no instance uses it.
+/***************************************************************/
+class IRStore
+{
+public:
+    /** Returns the result for the scene if any instance still holds it, or nullptr. */
+    std::shared_ptr<const TraceResult> find(juce::uint64 sceneHash);
+
+    /** Adds a result, or returns the one already held for its scene so the new copy can be dropped. */
+    std::shared_ptr<const TraceResult> add(std::shared_ptr<const TraceResult> result);
+
+private:
+    std::mutex mutex;
+    std::map<juce::uint64, std::weak_ptr<const TraceResult>> results;
+};
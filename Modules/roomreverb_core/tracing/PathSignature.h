@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <unordered_set>
+#include <juce_core/juce_core.h>
+
+/***************************************************************/
+// Specular path signatures
+//
+// A path is identified by the sequence of surfaces a ray has
+// reflected off before reaching the listener. In a room made of
+// planar surfaces that sequence defines a single image source,
+// so every ray that finds the same signature has found the same
+// reflection, however slightly its direction differs.
+/***************************************************************/
+
+using PathSignature = juce::uint64;
+
+// Signature of the direct path (no reflections). FNV-1a offset basis.
+const PathSignature emptyPathSignature = 14695981039346656037ULL;
+
+/** Returns the signature of a path extended by a reflection off the given surface. */
+inline PathSignature extendPathSignature(PathSignature signature, int surface) noexcept
+{
+    signature ^= (PathSignature)(surface + 1);
+    return signature * 1099511628211ULL; // FNV-1a prime
+}
+
+/** Returns the signature a path starts with at a particular sound source, so sources never share paths. */
+inline PathSignature sourcePathSignature(int source) noexcept
+{
+    return extendPathSignature(emptyPathSignature, -(source + 2));
+}
+
+/** Returns the signature of a path as heard at a particular receiver, so each receiver keeps its own copy of a path. */
+inline PathSignature receiverPathSignature(PathSignature signature, int receiver) noexcept
+{
+    return extendPathSignature(signature, -(receiver + 2));
+}
+
+/** A set of path signatures that can be inserted into from several tracing threads. */
+class PathSignatureSet
+{
+public:
+    /** Adds a signature, returning true if it had not been seen before. */
+    bool insert(PathSignature signature)
+    {
+        auto& shard = shards[signature % NUM_SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.signatures.insert(signature).second;
+    }
+
+    bool contains(PathSignature signature)
+    {
+        auto& shard = shards[signature % NUM_SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.signatures.count(signature) != 0;
+    }
+
+    size_t size()
+    {
+        size_t total = 0;
+        for (auto& shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.signatures.size();
+        }
+        return total;
+    }
+
+    void clear()
+    {
+        for (auto& shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.signatures.clear();
+        }
+    }
+
+private:
+    static const int NUM_SHARDS = 16;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_set<PathSignature> signatures;
+    };
+
+    Shard shards[NUM_SHARDS];
+};
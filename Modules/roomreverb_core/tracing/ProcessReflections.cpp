@@ -0,0 +1,713 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include "ProcessReflections.h"
+#include "../geometry/Spherical.h"
+#include "../geometry/SharedData.h"
+
+ProcessReflections::ProcessReflections() : workspacePool(*sharedWorkspacePool) {}
+
+ProcessReflections::ProcessReflections(TraceWorkspacePool& pool, bool useCache) : useIRCache(useCache), workspacePool(pool) {}
+
+std::shared_ptr<const TraceResult> ProcessReflections::run(TraceJob& jobToRun)
+{
+    DBG("Process Reflections Thread is running...");
+	job = &jobToRun;
+
+	roomSetup(*job->scene);
+
+	// Logging is off unless the job asks for it
+	if (job->traceLogFile != juce::File())
+	{
+		traceLog = std::make_unique<TraceLog>(job->traceLogFile, createTraceLogHeader());
+		if (!traceLog->isOpen())
+			traceLog.reset();
+	}
+
+	// Only trace scenes that haven't been traced before, by this instance or any other
+	std::shared_ptr<const TraceResult> result = irStore->find(sceneHash);
+	if (result != nullptr)
+	{
+		DBG("IR store hit");
+	}
+	else if (auto cached = useIRCache ? irCache.load(sceneHash) : nullptr)
+	{
+		DBG("IR cache hit");
+		result = irStore->add(std::move(cached));
+	}
+	else
+	{
+		// Working memory is only held for the duration of the trace
+		workspace = workspacePool.acquire();
+		workspace->taps.assign(soundSourcePositions.size() * scene.getNumReceivers(), {});
+		traceStartTime = batchStartTime = juce::Time::getMillisecondCounterHiRes();
+		lastPublishTime = 0.0;
+		newPathsSincePublish = false;
+
+		rayPaths = job->rayPaths;
+		if (rayPaths != nullptr)
+			rayPathTrace = rayPaths->beginTrace();
+		tracedPaths = 0;
+
+		std::shared_ptr<TraceResult> traced;
+		if (pass1() && pass2())
+		{
+			traced = populateIR();
+			traced->sceneHash = sceneHash;
+		}
+		workspacePool.release(std::move(workspace));
+		rayPaths = nullptr;
+
+		if (traced == nullptr)
+		{
+			DBG("Trace cancelled");
+			traceLog.reset();
+			job = nullptr;
+			return nullptr;
+		}
+
+		if (useIRCache)
+			irCache.store(sceneHash, *traced);
+		result = irStore->add(std::move(traced));
+	}
+
+	if (traceLog != nullptr)
+	{
+		logTaps(*result);
+		traceLog.reset();
+	}
+
+	job->setProgress(1.0f);
+	job = nullptr;
+	return result;
+}
+
+/***************************************************************/
+// Called after each batch of rays: publishes the progress, and
+// returns false if the job has been cancelled and the trace
+// should stop.
+//
+// For a job with a deadline, the IR so far is published when
+// the next batch would finish after the deadline, then again
+// every INTERMEDIATE_INTERVAL while new paths keep being found.
+/***************************************************************/
+bool ProcessReflections::batchFinished(float progress)
+{
+	job->setProgress(progress);
+	if (job->isCancelled())
+		return false;
+
+	double now = juce::Time::getMillisecondCounterHiRes();
+	if (job->deadline > 0.0 && job->onIntermediateResult != nullptr && newPathsSincePublish)
+	{
+		bool due = lastPublishTime == 0.0
+			? (now - traceStartTime) + (now - batchStartTime) >= job->deadline * 1000.0
+			: now - lastPublishTime >= INTERMEDIATE_INTERVAL * 1000.0;
+
+		if (due)
+		{
+			publishIntermediateResult();
+			now = juce::Time::getMillisecondCounterHiRes();
+		}
+	}
+
+	batchStartTime = now;
+	return true;
+}
+
+void ProcessReflections::publishIntermediateResult()
+{
+	auto result = populateIR();
+	result->sceneHash = sceneHash;
+	result->complete = false;
+	job->onIntermediateResult(std::move(result));
+
+	lastPublishTime = juce::Time::getMillisecondCounterHiRes();
+	newPathsSincePublish = false;
+	DBG("Intermediate IR published after " << (lastPublishTime - traceStartTime) << " ms");
+}
+
+ProcessReflections::~ProcessReflections()
+{
+}
+
+void TraceWorkspace::clear()
+{
+	rayDirections.clear();
+	rayHits.clear();
+	listenerHits.clear();
+	receiverHits.clear();
+	taps.clear();
+	raySegments.clear();
+	refinementOrigins.clear();
+	pathSignatures.clear();
+	directionHistogram.clear();
+	irEstimate.clear();
+	irEstimatePrevious.clear();
+}
+
+size_t TraceWorkspace::getCapacityBytes() const
+{
+	return rayDirections.capacity() * sizeof(rayDirections[0]) + rayHits.capacity() * sizeof(rayHits[0])
+		+ listenerHits.capacity() * sizeof(listenerHits[0]) + receiverHits.capacity() * sizeof(receiverHits[0])
+		+ taps.capacity() * sizeof(taps[0]) + raySegments.capacity() * sizeof(raySegments[0])
+		+ refinementOrigins.capacity() * sizeof(refinementOrigins[0]) + directionHistogram.capacity() * sizeof(float)
+		+ irEstimate.capacity() * sizeof(float) + irEstimatePrevious.capacity() * sizeof(float);
+}
+
+std::unique_ptr<TraceWorkspace> TraceWorkspacePool::acquire()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!spares.empty())
+		{
+			auto workspace = std::move(spares.back());
+			spares.pop_back();
+			return workspace;
+		}
+	}
+
+	return std::make_unique<TraceWorkspace>();
+}
+
+void TraceWorkspacePool::release(std::unique_ptr<TraceWorkspace> workspace)
+{
+	// Keep the capacity for the next job, but not the contents
+	workspace->clear();
+
+	if (workspace->getCapacityBytes() > maxSpareBytes)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if ((int)spares.size() < MAX_SPARE_WORKSPACES)
+		spares.push_back(std::move(workspace));
+}
+
+size_t TraceWorkspacePool::getSpareBytes()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t total = 0;
+	for (auto& spare : spares)
+		total += spare->getCapacityBytes();
+	return total;
+}
+
+juce::uint64 ProcessReflections::hashScene(const SharedData& sharedData)
+{
+	return IRCache::hashScene(sharedData, ENGINE_VERSION);
+}
+
+void ProcessReflections::roomSetup(const SharedData& sharedData)
+{
+	sceneHash = hashScene(sharedData);
+
+    roomPos = sharedData.roomPos;
+    roomSize = sharedData.roomSize;
+    listenerPos = sharedData.listenerPos;
+	listenerSize = sharedData.listenerSize;
+	soundSourcePositions = sharedData.soundSourcePositions;
+
+	speedOfSound = sharedData.speedOfSound;
+	additionalRays = sharedData.additionalRays;
+	rollOff = sharedData.rollOff;
+	delayBucketSize = sharedData.delayBucketSize;
+	numberPolarBuckets = sharedData.numberPolarBuckets;
+	maxRefinementRounds = sharedData.maxRefinementRounds;
+	numReflections = sharedData.numReflections;
+	refinementTolerance = sharedData.refinementTolerance;
+	maxRaysPerOrigin = 4 * additionalRays;
+	saturationRays = additionalRays;
+	receiverGridX = sharedData.receiverGridX;
+	receiverGridY = sharedData.receiverGridY;
+	receiverGridZ = sharedData.receiverGridZ;
+
+	// The room as the view draws it, already in world space
+	auto geometry = sharedData.geometry != nullptr ? sharedData.geometry : SceneGeometry::build(sharedData);
+	scene.clear();
+	scene.addGeometry(*geometry);
+	scene.addReceiver(listenerPos, listenerSize);
+
+	// Bounce paths don't depend on the listener, so a grid of receivers can be traced in the same pass.
+	// Receivers are kept a listener box clear of the walls.
+	receiverGrid.reset();
+	if (receiverGridX > 0 && receiverGridY > 0 && receiverGridZ > 0)
+	{
+		Vector3<float> gridMin, gridMax;
+		getReceiverGridBounds(sharedData, gridMin, gridMax);
+		receiverGrid = std::make_unique<ReceiverGrid>(gridMin, gridMax, receiverGridX, receiverGridY, receiverGridZ);
+		for (int cell = 0; cell < receiverGrid->getNumCells(); cell++)
+			scene.addReceiver(receiverGrid->getCellCentre(cell), listenerSize);
+	}
+}
+
+/***************************************************************/
+// Pass 1
+//
+// Send out rays in a spherically random distribution as
+// possible, with granularity set by POLAR_SUBDIVISIONS. 
+// Trace each ray through the room, storing the hits on every
+// receiver along its path. Every sound source sends out the
+// same set of directions, and all of them are traced in one
+// run against the same scene, in batches of RAY_BATCH_SIZE.
+// Each batch takes an even stride through every source and the
+// whole sphere, so the IR after any batch is a coarse version of
+// the final one rather than a slice of it.
+// Returns false if the job was cancelled.
+/***************************************************************/
+bool ProcessReflections::pass1()
+{
+	// Your method implementation
+	DBG("Process Room method called from thread!");
+
+	random.setSeed(1);
+	float polar, azimuth;
+	workspace->rayDirections.resize(2 * POLAR_SUBDIVISIONS * POLAR_SUBDIVISIONS);
+	for (int i = 0; i < 2 * POLAR_SUBDIVISIONS; i++) { //azimuth
+		for (int j = 0; j < POLAR_SUBDIVISIONS; j++) { //polar
+			polar = (juce::MathConstants<float>::pi / 2) - std::asin(1 - 2 * random.nextFloat()); // Distribute the rays around the sphere as randomly as possible (no clustering at the poles)
+			azimuth = random.nextFloat() * 2.0 * juce::MathConstants<float>::pi;
+			Spherical rayDirectionS(1.0f, azimuth, polar);
+			Cartesian rayDirectionC = rayDirectionS.sph_to_car();
+			workspace->rayDirections[i * POLAR_SUBDIVISIONS + j] = Vector3<float>(rayDirectionC.get_x(), rayDirectionC.get_y(), rayDirectionC.get_z());
+		}
+	}
+
+	// Only the first ray to find each specular path at each receiver contributes it
+	workspace->listenerHits.clear();
+	workspace->pathSignatures.clear();
+	int numDirections = (int)workspace->rayDirections.size();
+	workspace->rayHits.assign(soundSourcePositions.size() * numDirections, 0);
+	int numRays = (int)workspace->rayHits.size();
+	int numBatches = (numRays + RAY_BATCH_SIZE - 1) / RAY_BATCH_SIZE;
+	for (int batch = 0; batch < numBatches; batch++)
+	{
+		for (int ray = batch; ray < numRays; ray += numBatches)
+		{
+			tracePath(ray / numDirections, workspace->rayDirections[ray % numDirections], ray, workspace->rayHits[ray]);
+		}
+
+		if (!batchFinished(PASS1_PROGRESS * (batch + 1) / numBatches))
+			return false;
+	}
+
+	return true;
+}
+
+/***************************************************************/
+// Pass 2
+// 
+// Adaptive refinement of the pass 1 hits. Each pass 1 ray that
+// reached the listener is refined once, however many bounces
+// hit. Additional rays are sent out in rounds in the vicinity
+// of those rays, looking for specular paths that pass 1 missed.
+// Each round allocates rays in proportion to how productive that
+// direction has been (a spherical histogram of listener hits,
+// one per source) and how much its yield of new paths varies.
+// Origins whose recent rays only rediscover known paths are
+// saturated and get no more rays. Rounds stop once the IR
+// estimate changes by less than refinementTolerance. The rounds
+// are shared by all the sources, so one converged IR estimate
+// ends the whole run. Returns false if the job was cancelled.
+/***************************************************************/
+bool ProcessReflections::pass2()
+{
+	random2.setSeed(2);
+	workspace->refinementOrigins.clear();
+	int numDirectionBins = 2 * numberPolarBuckets * numberPolarBuckets;
+	workspace->directionHistogram.assign(soundSourcePositions.size() * numDirectionBins, 0.0f);
+	workspace->irEstimatePrevious.clear();
+
+	// Every pass 1 ray that reached a receiver is refined once
+	int numDirections = (int)workspace->rayDirections.size();
+	for (int ray = 0; ray < (int)workspace->rayHits.size(); ray++)
+	{
+		if (workspace->rayHits[ray] == 0)
+			continue;
+
+		RefinementOrigin refinementOrigin;
+		refinementOrigin.direction = workspace->rayDirections[ray % numDirections];
+		refinementOrigin.source = ray / numDirections;
+		refinementOrigin.ray = ray;
+		refinementOrigin.histogramBin = refinementOrigin.source * numDirectionBins + directionBin(refinementOrigin.direction);
+		workspace->refinementOrigins.push_back(refinementOrigin);
+		workspace->directionHistogram[refinementOrigin.histogramBin] += (float)workspace->rayHits[ray];
+	}
+
+	if (workspace->refinementOrigins.empty())
+		return true;
+
+	size_t pass1Paths = workspace->listenerHits.size();
+	updateIREstimate();
+
+	std::vector<int> raysPerOrigin;
+	for (int round = 0; round < maxRefinementRounds; round++)
+	{
+		allocateRefinementRays(round, raysPerOrigin);
+
+		int raysThisRound = 0;
+		for (int o = 0; o < (int)workspace->refinementOrigins.size(); o++)
+		{
+			// Convert original ray direction to Spherical coordinates
+			Cartesian origDirC(workspace->refinementOrigins[o].direction.x, workspace->refinementOrigins[o].direction.y, workspace->refinementOrigins[o].direction.z);
+			Spherical origDirS = origDirC.car_to_sph();
+			for (int j = 0; j < raysPerOrigin[o]; j++)
+			{
+				// Calculate distribution range from original number of rays
+				float polar = origDirS.get_phi() + (std::asin(1 - 2 * random2.nextFloat())) / POLAR_SUBDIVISIONS;
+				float azimuth = origDirS.get_theta() + (2 * juce::MathConstants<float>::pi * (0.5f - random2.nextFloat())) / (2 * POLAR_SUBDIVISIONS);
+				azimuth = fmodf(azimuth, 2 * juce::MathConstants<float>::pi);
+				Spherical rayDirectionS(1.0f, azimuth, polar);
+				Cartesian rayDirectionC = rayDirectionS.sph_to_car();
+				Vector3<float> rayDirection = Vector3<float>(rayDirectionC.get_x(), rayDirectionC.get_y(), rayDirectionC.get_z());
+
+				int hits = 0;
+				auto& origin = workspace->refinementOrigins[o];
+				float newPaths = (float)tracePath(origin.source, rayDirection, origin.ray, hits);
+
+				origin.raysCast++;
+				origin.raysSinceNewPath = newPaths > 0.0f ? 0 : origin.raysSinceNewPath + 1;
+				origin.newPathSum += newPaths;
+				origin.newPathSumSquares += newPaths * newPaths;
+				workspace->directionHistogram[origin.histogramBin] += (float)hits;
+				raysThisRound++;
+
+				// Each round is given an equal share of what's left of the progress bar
+				if (raysThisRound % RAY_BATCH_SIZE == 0
+					&& !batchFinished(PASS1_PROGRESS + (1.0f - PASS1_PROGRESS) * (round + (o + 1.0f) / workspace->refinementOrigins.size()) / maxRefinementRounds))
+					return false;
+			}
+		}
+
+		float change = updateIREstimate();
+		DBG("Pass 2 round " << round << ": " << raysThisRound << " rays, " << (int)(workspace->listenerHits.size() - pass1Paths) << " new paths, IR estimate change " << change);
+
+		if (raysThisRound == 0 || change < refinementTolerance)
+			break;
+
+		if (!batchFinished(PASS1_PROGRESS + (1.0f - PASS1_PROGRESS) * (round + 1.0f) / maxRefinementRounds))
+			return false;
+	}
+
+	return true;
+}
+
+/***************************************************************/
+// Decide how many refinement rays each origin gets this round.
+// The first round seeds every origin evenly so its variance
+// can be measured; later rounds share the budget out by hit
+// density around the origin times the uncertainty of its yield
+// of new paths (Neyman allocation). Saturated origins are
+// skipped.
+/***************************************************************/
+void ProcessReflections::allocateRefinementRays(int round, std::vector<int>& raysPerOrigin)
+{
+	raysPerOrigin.assign(workspace->refinementOrigins.size(), 0);
+
+	if (round == 0)
+	{
+		std::fill(raysPerOrigin.begin(), raysPerOrigin.end(), std::max(2, additionalRays / 2));
+		return;
+	}
+
+	float maxDensity = *std::max_element(workspace->directionHistogram.begin(), workspace->directionHistogram.end());
+	std::vector<float> scores(workspace->refinementOrigins.size(), 0.0f);
+	float totalScore = 0.0f;
+	for (size_t o = 0; o < workspace->refinementOrigins.size(); o++)
+	{
+		auto& origin = workspace->refinementOrigins[o];
+		if (origin.raysCast >= maxRaysPerOrigin || origin.raysSinceNewPath >= saturationRays)
+			continue;
+
+		float mean = origin.newPathSum / origin.raysCast;
+		float variance = std::max(0.0f, origin.newPathSumSquares / origin.raysCast - mean * mean);
+		float density = workspace->directionHistogram[origin.histogramBin] / maxDensity;
+		scores[o] = density * (std::sqrt(variance) + 1.0f / std::sqrt((float)origin.raysCast));
+		totalScore += scores[o];
+	}
+
+	if (totalScore <= 0.0f)
+		return;
+
+	float budget = (float)(workspace->refinementOrigins.size() * additionalRays) / 2.0f;
+	for (size_t o = 0; o < workspace->refinementOrigins.size(); o++)
+	{
+		int rays = (int)(budget * scores[o] / totalScore + 0.5f);
+		raysPerOrigin[o] = std::min(rays, maxRaysPerOrigin - workspace->refinementOrigins[o].raysCast);
+	}
+}
+
+/***************************************************************/
+// Trace a single ray from a sound source through the room.
+// Receiver hits along a path not found before at that receiver
+// are added to listenerHits and the IR taps; hits counts every
+// receiver hit.
+// Returns the number of new paths.
+/***************************************************************/
+int ProcessReflections::tracePath(int source, Vector3<float> direction, int origin, int& hits)
+{
+	Ray ray;
+	ray.origin = soundSourcePositions[source];
+	ray.direction = direction;
+
+	int newPaths = 0;
+	float accDistance = 0.0f;
+	PathSignature signature = sourcePathSignature(source);
+	SceneHit sceneHit;
+	hits = 0;
+
+	// A sample of the paths is shown by the view while it is open
+	bool sampled = rayPaths != nullptr && tracedPaths++ % RAY_PATH_DECIMATION == 0 && rayPaths->isEnabled();
+	if (sampled)
+		workspace->raySegments.clear();
+
+	for (int k = 0; k < numReflections - 1; k++)
+	{
+		bool surfaceHit = scene.intersect(ray, sceneHit, workspace->receiverHits);
+
+		if (sampled && surfaceHit)
+		{
+			RaySegment segment;
+			segment.start = ray.origin;
+			segment.end = sceneHit.point;
+			segment.trace = rayPathTrace;
+			segment.reflection = k;
+			segment.reachesListener = std::any_of(workspace->receiverHits.begin(), workspace->receiverHits.end(),
+				[](const SceneHit& receiverHit) { return receiverHit.surface == 0; });
+			workspace->raySegments.push_back(segment);
+		}
+
+		for (auto& receiverHit : workspace->receiverHits)
+		{
+			hits++;
+
+			if (workspace->pathSignatures.insert(receiverPathSignature(signature, receiverHit.surface)))
+			{
+				Vector3<float> hitDirection = ray.direction.normalised();
+				Cartesian dirC(hitDirection.x, -hitDirection.z, -hitDirection.y);
+				Spherical dirS = dirC.car_to_sph();
+
+				ListenerHit hit;
+				hit.origin = origin;
+				hit.source = source;
+				hit.receiver = receiverHit.surface;
+				hit.reflection = k;
+				hit.delay = (accDistance + (receiverHit.point - ray.origin).length()) * 1000.0f / speedOfSound;
+				hit.azimuth = dirS.get_theta();
+				hit.polar = dirS.get_phi();
+				hit.weight = 1.0f;
+				workspace->listenerHits.push_back(hit);
+				addTap(hit);
+
+				if (traceLog != nullptr)
+					traceLog->addHit(hit.source, hit.origin, hit.receiver, hit.reflection, hit.delay, hit.azimuth, hit.polar, hit.weight);
+				newPaths++;
+			}
+		}
+
+		if (!surfaceHit)
+			break;
+
+		accDistance += (sceneHit.point - ray.origin).length();
+		ray.direction = reflect(ray.direction.normalised(), sceneHit.normal);
+		ray.origin = sceneHit.point;
+		signature = extendPathSignature(signature, sceneHit.surface);
+	}
+
+	if (sampled && !workspace->raySegments.empty())
+		rayPaths->push(workspace->raySegments.data(), (int)workspace->raySegments.size());
+
+	if (traceLog != nullptr)
+		traceLog->addRay(source, origin, direction, hits);
+
+	return newPaths;
+}
+
+int ProcessReflections::directionBin(Vector3<float> direction)
+{
+	Cartesian dirC(direction.x, direction.y, direction.z);
+	Spherical dirS = dirC.car_to_sph();
+	int azimuthBin = juce::jlimit(0, 2 * numberPolarBuckets - 1, (int)(dirS.get_theta() * numberPolarBuckets / juce::MathConstants<float>::pi));
+	int polarBin = juce::jlimit(0, numberPolarBuckets - 1, (int)(dirS.get_phi() * numberPolarBuckets / juce::MathConstants<float>::pi));
+	return azimuthBin * numberPolarBuckets + polarBin;
+}
+
+/***************************************************************/
+// Add a newly found path to the taps of its source and receiver,
+// and to the coarse (1 ms) energy envelope of the IR, so neither
+// has to be rebuilt from every hit when it is needed.
+/***************************************************************/
+void ProcessReflections::addTap(const ListenerHit& hit)
+{
+	float delay = std::ceil(hit.delay * 100.0f) / (delayBucketSize * 100.0f);
+	float attenuation = hit.weight / std::pow(delay, rollOff);
+
+	// Apply polarity to impulses
+	float s = hit.reflection % 2 == 0 ? 1.0f : -1.0f;
+
+	TapKey key{ delay, // Delay
+		std::ceil(hit.azimuth * numberPolarBuckets / juce::MathConstants<float>::pi), // Azimuth
+		std::ceil(hit.polar * numberPolarBuckets / juce::MathConstants<float>::pi) }; // Elevation
+	workspace->taps[hit.source * scene.getNumReceivers() + hit.receiver][key] += s * attenuation;
+
+	size_t bin = (size_t)hit.delay;
+	if (bin >= workspace->irEstimate.size())
+		workspace->irEstimate.resize(bin + 1, 0.0f);
+	workspace->irEstimate[bin] += attenuation * attenuation;
+
+	newPathsSincePublish = true;
+}
+
+/***************************************************************/
+// Return the relative change of the IR energy envelope, over all
+// receivers, since the previous call.
+/***************************************************************/
+float ProcessReflections::updateIREstimate()
+{
+	if (workspace->irEstimatePrevious.empty())
+	{
+		workspace->irEstimatePrevious = workspace->irEstimate;
+		return 1.0f;
+	}
+
+	float difference = 0.0f, total = 0.0f;
+	for (size_t i = 0; i < workspace->irEstimate.size(); i++)
+	{
+		float previous = i < workspace->irEstimatePrevious.size() ? workspace->irEstimatePrevious[i] : 0.0f;
+		difference += (workspace->irEstimate[i] - previous) * (workspace->irEstimate[i] - previous);
+		total += workspace->irEstimate[i] * workspace->irEstimate[i];
+	}
+
+	workspace->irEstimatePrevious = workspace->irEstimate;
+	return total > 0.0f ? std::sqrt(difference / total) : 0.0f;
+}
+
+/***************************************************************/
+// Populate the IRs of every source, at the listener and at each
+// cell of the receiver grid
+/***************************************************************/
+std::shared_ptr<TraceResult> ProcessReflections::populateIR()
+{
+	auto result = std::make_shared<TraceResult>();
+	for (int source = 0; source < (int)soundSourcePositions.size(); source++)
+	{
+		SourceResult sourceResult;
+		sourceResult.listenerIR = buildSparseIR(source, 0);
+
+		if (receiverGrid != nullptr)
+		{
+			std::vector<SparseIR> cellIRs;
+			for (int cell = 0; cell < receiverGrid->getNumCells(); cell++)
+				cellIRs.push_back(buildSparseIR(source, cell + 1));
+
+			auto grid = std::make_shared<ReceiverGrid>(*receiverGrid);
+			grid->setCellIRs(cellIRs);
+			sourceResult.receiverGrid = std::move(grid);
+		}
+
+		result->sources.push_back(std::move(sourceResult));
+	}
+
+	return result;
+}
+
+/***************************************************************/
+// The scene parameters at the start of a trace log
+/***************************************************************/
+TraceLogHeader ProcessReflections::createTraceLogHeader() const
+{
+	TraceLogHeader header{};
+	memcpy(header.magic, TraceLogFormat::magic, sizeof(header.magic));
+	header.version = TraceLogFormat::version;
+	header.sceneHash = sceneHash;
+
+	auto copy = [](Vector3<float> v, float* destination) { destination[0] = v.x; destination[1] = v.y; destination[2] = v.z; };
+	copy(roomSize, header.roomSize);
+	copy(roomPos, header.roomPos);
+	copy(listenerPos, header.listenerPos);
+	copy(listenerSize, header.listenerSize);
+
+	header.speedOfSound = speedOfSound;
+	header.rollOff = rollOff;
+	header.delayBucketSize = delayBucketSize;
+	header.refinementTolerance = refinementTolerance;
+	header.numSources = (int32_t)soundSourcePositions.size();
+	header.numReceivers = scene.getNumReceivers();
+	header.numReflections = numReflections;
+	header.additionalRays = additionalRays;
+	header.numberPolarBuckets = numberPolarBuckets;
+	header.maxRefinementRounds = maxRefinementRounds;
+	header.receiverGrid[0] = receiverGridX;
+	header.receiverGrid[1] = receiverGridY;
+	header.receiverGrid[2] = receiverGridZ;
+	return header;
+}
+
+/***************************************************************/
+// Log the final taps of every source at every receiver
+/***************************************************************/
+void ProcessReflections::logTaps(const TraceResult& result)
+{
+	for (int source = 0; source < (int)result.sources.size(); source++)
+	{
+		auto& sourceResult = result.sources[source];
+		traceLog->addTaps(source, 0, sourceResult.listenerIR.data(), (int)sourceResult.listenerIR.size());
+
+		if (sourceResult.receiverGrid != nullptr)
+		{
+			for (int cell = 0; cell < sourceResult.receiverGrid->getNumCells(); cell++)
+			{
+				int numTaps;
+				const ImpulseTap* taps = sourceResult.receiverGrid->getTaps(cell, numTaps);
+				traceLog->addTaps(source, cell + 1, taps, numTaps);
+			}
+		}
+	}
+}
+
+/***************************************************************/
+// Build the sparse IR heard at one receiver from one source from
+// its taps so far, normalised to a peak of 1.0f.
+/***************************************************************/
+SparseIR ProcessReflections::buildSparseIR(int source, int receiver)
+{
+	// The taps are already merged and sorted by delay, azimuth, then polar buckets
+	const auto& taps = workspace->taps[source * scene.getNumReceivers() + receiver];
+	SparseIR sparseIR;
+	sparseIR.reserve(taps.size());
+	float maxValue = 0.0f;
+	for (auto& [key, gain] : taps)
+	{
+		sparseIR.push_back({ key.delay, key.azimuth, key.elevation, gain });
+		if (std::fabs(gain) > maxValue) maxValue = std::fabs(gain);
+	}
+
+	// Normalise attenuation to max 1.0f, and convert delay buckets to ms
+	for (auto& tap : sparseIR)
+	{
+		if (maxValue > 0.0f) tap.gain /= maxValue;
+		tap.delay *= delayBucketSize;
+	}
+
+	return sparseIR;
+}
+
+Vector3<float> ProcessReflections::reflect(Vector3<float> line, Vector3<float> normal) 
+{
+	// Reflection equation: d - 2(d.n)n
+	return line - (normal * (line * normal)) * (2.0f);
+}
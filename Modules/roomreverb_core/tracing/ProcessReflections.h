@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#pragma once
+#include <iostream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../geometry/AcousticScene.h"
+#include "PathSignature.h"
+#include "RayPaths.h"
+#include "TraceResult.h"
+#include "IRCache.h"
+#include "IRStore.h"
+#include "../geometry/SharedData.h"
+#include "TraceJob.h"
+#include "TraceLog.h"
+#include <juce_core/juce_core.h>
+
+// A listener hit, tagged with the pass 1 ray it came from (or refines)
+struct ListenerHit {
+    int origin;        // pass 1 ray, (source * 2 * POLAR_SUBDIVISIONS + azimuth) * POLAR_SUBDIVISIONS + polar
+    int source;
+    int receiver;      // 0 is the listener, then the cells of the receiver grid
+    int reflection;    // segment the receiver was hit on
+    float delay;       // ms
+    float azimuth, polar;
+    float weight;
+};
+
+// A pass 1 ray that reached a receiver, and the refinement statistics gathered around it
+struct RefinementOrigin {
+    Vector3<float> direction;
+    int source = 0;
+    int ray = 0;
+    int histogramBin = 0;
+    int raysCast = 0;
+    int raysSinceNewPath = 0;
+    float newPathSum = 0.0f, newPathSumSquares = 0.0f; // new paths found per refinement ray
+};
+
+// A tap of a sparse IR before normalisation: delay bucket, azimuth and polar buckets
+struct TapKey {
+    float delay, azimuth, elevation;
+
+    bool operator< (const TapKey& other) const
+    {
+        if (delay != other.delay) return delay < other.delay;
+        if (azimuth != other.azimuth) return azimuth < other.azimuth;
+        return elevation < other.elevation;
+    }
+};
+
+// Working memory of one trace job. Only exists while a job runs.
+struct TraceWorkspace {
+    std::vector<Vector3<float>> rayDirections; // pass 1 ray directions, shared by every source
+    std::vector<int> rayHits;                         // receiver hits along each pass 1 ray, source by source
+    std::vector<ListenerHit> listenerHits;            // first hit on each unique path, from either pass
+    std::vector<SceneHit> receiverHits;
+    std::vector<std::map<TapKey, float>> taps;        // summed gains per source and receiver, kept up to date as paths are found
+    std::vector<RaySegment> raySegments;              // the path being sampled for the view, see TraceJob::rayPaths
+
+    // Adaptive refinement (pass 2) state
+    std::vector<RefinementOrigin> refinementOrigins;
+    PathSignatureSet pathSignatures; // every unique path found so far, by either pass
+    std::vector<float> directionHistogram; // receiver hits per source and origin direction bucket
+    std::vector<float> irEstimate, irEstimatePrevious; // energy per ms, used as the stop criterion
+
+    void clear();
+
+    /** Returns the memory held by the workspace's vectors, in use or not. */
+    size_t getCapacityBytes() const;
+};
+
+/***************************************************************/
+// Workspaces released by finished jobs, kept for the next job
+// whichever plugin instance runs it. Only a few are kept, so
+// idle instances don't hold on to any working memory.
+//
+// A pool can also bound what it keeps: a workspace that grew
+// past the limit is freed instead, so a worker tracing one scene
+// after another never holds more than that between scenes.
+/***************************************************************/
+class TraceWorkspacePool
+{
+public:
+    TraceWorkspacePool() = default;
+    explicit TraceWorkspacePool(size_t maxSpareBytesToKeep) : maxSpareBytes(maxSpareBytesToKeep) {}
+
+    std::unique_ptr<TraceWorkspace> acquire();
+    void release(std::unique_ptr<TraceWorkspace> workspace);
+
+    /** Returns the memory held by the spare workspaces. */
+    size_t getSpareBytes();
+
+private:
+    static const int MAX_SPARE_WORKSPACES = 1;
+    const size_t maxSpareBytes = std::numeric_limits<size_t>::max();
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceWorkspace>> spares;
+};
+
+/***************************************************************/
+// The tracer. Runs one TraceJob at a time on the calling thread,
+// see TraceScheduler. Scenes already held in the IRStore or the
+// IRCache aren't traced again.
+/***************************************************************/
+class ProcessReflections
+{
+public:
+    ProcessReflections();
+
+    /** A tracer with working memory of its own rather than the process's, e.g. one per worker of a batch render,
+        which only uses the IRCache if asked to. */
+    ProcessReflections(TraceWorkspacePool& pool, bool useIRCache);
+
+    ~ProcessReflections();
+
+    /** Traces the job's scene, or returns nullptr if the job was cancelled. */
+    std::shared_ptr<const TraceResult> run(TraceJob& job);
+
+    /** The key of the scene's result in the IRStore and IRCache. */
+    static juce::uint64 hashScene(const SharedData& sharedData);
+
+    void roomSetup(const SharedData& sharedData);
+    bool pass1();
+    bool pass2();
+    std::shared_ptr<TraceResult> populateIR();
+
+private:
+    TraceJob* job = nullptr; // only set during run()
+    Vector3<float> roomPos, roomSize, listenerPos, listenerSize;
+    std::vector<Vector3<float>> soundSourcePositions;
+    AcousticScene scene;
+    std::unique_ptr<ReceiverGrid> receiverGrid;
+
+    IRCache irCache;
+    const bool useIRCache = true;
+    juce::SharedResourcePointer<IRStore> irStore;
+    juce::uint64 sceneHash = 0;
+
+    static const int POLAR_SUBDIVISIONS = 80;
+    static const int ENGINE_VERSION = 2; // bump whenever a change alters traced IRs, so cached ones aren't reused
+    static const int RAY_BATCH_SIZE = 1024; // rays traced between cancellation checks and progress updates
+    static constexpr float PASS1_PROGRESS = 0.3f; // share of the progress bar given to pass 1
+    static constexpr double INTERMEDIATE_INTERVAL = 0.25; // seconds between intermediate results once the deadline has been met
+    static const int RAY_PATH_DECIMATION = 64; // one path in this many is shown by the view
+
+    juce::SharedResourcePointer<TraceWorkspacePool> sharedWorkspacePool;
+    TraceWorkspacePool& workspacePool;
+    std::unique_ptr<TraceWorkspace> workspace; // only set during run()
+
+    // Progressive tracing, see TraceJob::deadline
+    double traceStartTime = 0.0, batchStartTime = 0.0, lastPublishTime = 0.0; // ms
+    bool newPathsSincePublish = false;
+
+    // Paths sampled for the view, only set during a trace with a RayPathRing
+    RayPathRing* rayPaths = nullptr;
+    juce::uint32 rayPathTrace = 0;
+    int tracedPaths = 0;
+
+    std::unique_ptr<TraceLog> traceLog; // only set during a run() of a job with a TraceJob::traceLogFile
+
+    juce::Random random, random2;
+    float speedOfSound, rollOff, delayBucketSize, refinementTolerance;
+    int additionalRays, numberPolarBuckets, maxRefinementRounds, maxRaysPerOrigin, saturationRays, numReflections;
+    int receiverGridX, receiverGridY, receiverGridZ;
+
+    bool batchFinished(float progress);
+    int tracePath(int source, Vector3<float> direction, int origin, int& hits);
+    int directionBin(Vector3<float> direction);
+    void allocateRefinementRays(int round, std::vector<int>& raysPerOrigin);
+    void addTap(const ListenerHit& hit);
+    void publishIntermediateResult();
+    float updateIREstimate();
+    TraceLogHeader createTraceLogHeader() const;
+    void logTaps(const TraceResult& result);
+    SparseIR buildSparseIR(int source, int receiver);
+    Vector3<float> reflect(Vector3<float> line, Vector3<float> normal);
+};
\ No newline at end of file
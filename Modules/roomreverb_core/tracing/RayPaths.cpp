@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "RayPaths.h"
+
+RayPathRing::RayPathRing(int capacity) : fifo(capacity), buffer((size_t)capacity)
+{
+}
+
+bool RayPathRing::push(const RaySegment* segments, int numSegments)
+{
+    // A cancelled trace may still be finishing its batch while the next one starts; the second writer drops its path
+    if (writing.exchange(true, std::memory_order_acquire))
+        return false;
+
+    bool added = fifo.getFreeSpace() >= numSegments;
+    if (added)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSegments, start1, size1, start2, size2);
+        std::copy(segments, segments + size1, buffer.begin() + start1);
+        std::copy(segments + size1, segments + size1 + size2, buffer.begin() + start2);
+        fifo.finishedWrite(size1 + size2);
+    }
+
+    writing.store(false, std::memory_order_release);
+    return added;
+}
+
+int RayPathRing::pop(RaySegment* destination, int maxSegments)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxSegments, start1, size1, start2, size2);
+    std::copy(buffer.begin() + start1, buffer.begin() + start1 + size1, destination);
+    std::copy(buffer.begin() + start2, buffer.begin() + start2 + size2, destination + size1);
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+RayPathLines::RayPathLines(int maxSegments) : vertices(2 * (size_t)maxSegments)
+{
+}
+
+void RayPathLines::add(const RaySegment* segments, int count)
+{
+    int maxSegments = getCapacity() / 2;
+    for (int i = 0; i < count; i++)
+    {
+        if (segments[i].trace != trace)
+        {
+            trace = segments[i].trace;
+            numSegments = nextSegment = 0;
+            changedStart = changedEnd = 0;
+        }
+
+        packSegment(segments[i], &vertices[2 * (size_t)nextSegment]);
+
+        // Widen the changed range; once the writes wrap around it covers the whole buffer
+        int first = 2 * nextSegment;
+        if (changedStart == changedEnd)
+        {
+            changedStart = first;
+            changedEnd = first + 2;
+        }
+        else if (first >= changedEnd)
+        {
+            changedEnd = first + 2;
+        }
+        else
+        {
+            changedStart = 0;
+            changedEnd = getCapacity();
+        }
+
+        nextSegment = (nextSegment + 1) % maxSegments;
+        numSegments = juce::jmin(numSegments + 1, maxSegments);
+    }
+}
+
+juce::Range<int> RayPathLines::takeChangedRange()
+{
+    juce::Range<int> range(changedStart, changedEnd);
+    changedStart = changedEnd = 0;
+    return range;
+}
+
+void RayPathLines::packSegment(const RaySegment& segment, Vertex* destination)
+{
+    // Paths that reach the listener stand out; the others fade with each reflection
+    float colour[4] = { 0.3f, 0.7f, 1.0f, juce::jmax(0.1f, 0.5f - 0.03f * (float)segment.reflection) };
+    if (segment.reachesListener)
+    {
+        colour[0] = 1.0f;
+        colour[1] = 0.85f;
+        colour[2] = 0.2f;
+        colour[3] = 0.9f;
+    }
+
+    const Vector3<float> ends[2] = { segment.start, segment.end };
+    for (int i = 0; i < 2; i++)
+    {
+        destination[i].position[0] = ends[i].x;
+        destination[i].position[1] = ends[i].y;
+        destination[i].position[2] = ends[i].z;
+        std::copy(colour, colour + 4, destination[i].colour);
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class RayPathsTests : public juce::UnitTest
+{
+public:
+    RayPathsTests() : juce::UnitTest("RayPaths", "RoomReverb") {}
+
+    void runTest() override
+    {
+        beginTest("Ring drops paths that don't fit and wraps");
+        {
+            RayPathRing ring(8); // holds 7 segments
+            auto path = makeSegments(1, 5);
+            RaySegment popped[8];
+
+            expect(ring.push(path.data(), 5));
+            expect(!ring.push(path.data(), 5));
+            expectEquals(ring.getNumReady(), 5);
+            expectEquals(ring.pop(popped, 8), 5);
+
+            // Starts at segment 5, so the second half goes at the start of the buffer
+            expect(ring.push(path.data(), 5));
+            expectEquals(ring.pop(popped, 8), 5);
+            for (int i = 0; i < 5; i++)
+                expectEquals(popped[i].reflection, i);
+        }
+
+        beginTest("Changed range grows with the added segments");
+        {
+            RayPathLines lines(4);
+            auto segments = makeSegments(1, 3);
+
+            lines.add(segments.data(), 2);
+            expect(lines.takeChangedRange() == juce::Range<int>(0, 4));
+            expect(lines.takeChangedRange().isEmpty());
+
+            lines.add(segments.data() + 2, 1);
+            expect(lines.takeChangedRange() == juce::Range<int>(4, 6));
+            expectEquals(lines.getNumVertices(), 6);
+        }
+
+        beginTest("Changed range covers the buffer once the writes wrap");
+        {
+            RayPathLines lines(4);
+            auto segments = makeSegments(1, 6);
+
+            lines.add(segments.data(), 3);
+            lines.takeChangedRange();
+
+            // The fourth segment fills the buffer, the fifth replaces the first
+            lines.add(segments.data() + 3, 2);
+            expect(lines.takeChangedRange() == juce::Range<int>(0, 8));
+            expectEquals(lines.getNumVertices(), 8);
+            expectEquals(lines.getVertices()[0].position[0], segments[4].start.x);
+        }
+
+        beginTest("A new trace starts again");
+        {
+            RayPathLines lines(4);
+            auto first = makeSegments(1, 4);
+            auto second = makeSegments(2, 1);
+
+            lines.add(first.data(), 4);
+            lines.takeChangedRange();
+            lines.add(second.data(), 1);
+
+            expectEquals(lines.getNumVertices(), 2);
+            expect(lines.takeChangedRange() == juce::Range<int>(0, 2));
+            expectEquals(lines.getVertices()[1].position[1], second[0].end.y);
+        }
+    }
+
+private:
+    static std::vector<RaySegment> makeSegments(juce::uint32 trace, int count)
+    {
+        std::vector<RaySegment> segments((size_t)count);
+        for (int i = 0; i < count; i++)
+        {
+            auto& segment = segments[(size_t)i];
+            segment.start = Vector3<float>((float)i, 0.0f, 0.0f);
+            segment.end = Vector3<float>((float)i, 1.0f + (float)trace, 0.0f);
+            segment.trace = trace;
+            segment.reflection = i;
+        }
+        return segments;
+    }
+};
+
+static RayPathsTests rayPathsTests;
+
+#endif
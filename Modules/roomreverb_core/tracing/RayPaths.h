@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <atomic>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "../geometry/Vector3.h"
+
+// One straight section of a traced path, in world space
+struct RaySegment {
+    Vector3<float> start, end;
+    juce::uint32 trace = 0;       // id of the trace it came from, see RayPathRing::beginTrace()
+    int reflection = 0;           // number of reflections before the segment
+    bool reachesListener = false; // the segment crosses the listener
+};
+
+/***************************************************************/
+// Carries a sample of the tracer's paths to the room view.
+//
+// The tracer pushes whole paths and never waits: a path is
+// dropped if there is no room for it, or if a cancelled trace of
+// the same instance is still writing. The view reads from the
+// other end. Nothing is pushed unless a view has enabled it.
+/***************************************************************/
+class RayPathRing
+{
+public:
+    explicit RayPathRing(int capacity = DEFAULT_CAPACITY);
+
+    /** Enabled while a view is reading, so closed editors cost the tracer nothing. */
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled = shouldBeEnabled; }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    /** Returns an id for the segments of a new trace, so the view can drop the previous one's. */
+    juce::uint32 beginTrace() noexcept { return ++numTraces; }
+
+    /** Adds the segments of one path, or returns false if they were dropped. Call from the tracing thread. */
+    bool push(const RaySegment* segments, int numSegments);
+
+    /** Takes up to maxSegments, returning how many. Call from a single reading thread. */
+    int pop(RaySegment* destination, int maxSegments);
+
+    int getNumReady() const { return fifo.getNumReady(); }
+
+    static const int DEFAULT_CAPACITY = 16384;
+
+private:
+    juce::AbstractFifo fifo;
+    std::vector<RaySegment> buffer;
+    std::atomic<bool> writing{ false };
+    std::atomic<bool> enabled{ false };
+    std::atomic<juce::uint32> numTraces{ 0 };
+};
+
+/***************************************************************/
+// The vertices of the ray paths drawn by the view: two per
+// segment, coloured by what the segment reached. The newest
+// segments replace the oldest once the buffer is full, and only
+// the range changed since the last upload is sent to the GPU.
+/***************************************************************/
+class RayPathLines
+{
+public:
+    struct Vertex {
+        float position[3];
+        float colour[4];
+    };
+
+    explicit RayPathLines(int maxSegments = MAX_SEGMENTS);
+
+    /** Adds segments, starting again if they belong to a newer trace. */
+    void add(const RaySegment* segments, int numSegments);
+
+    const Vertex* getVertices() const { return vertices.data(); }
+    int getNumVertices() const { return 2 * numSegments; }
+    int getCapacity() const { return (int)vertices.size(); } // vertices
+
+    /** Returns the vertices changed since the last call, and marks them uploaded. */
+    juce::Range<int> takeChangedRange();
+
+    /** Marks every vertex as changed, e.g. after the GPU buffer has been recreated. */
+    void markAllChanged() { changedStart = 0; changedEnd = getNumVertices(); }
+
+    static void packSegment(const RaySegment& segment, Vertex* destination);
+
+    static const int MAX_SEGMENTS = 32768;
+
+private:
+    std::vector<Vertex> vertices;
+    int numSegments = 0, nextSegment = 0;
+    int changedStart = 0, changedEnd = 0; // vertices
+    juce::uint32 trace = 0;
+};
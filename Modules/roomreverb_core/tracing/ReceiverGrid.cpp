@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#include "ReceiverGrid.h"
+
+ReceiverGrid::ReceiverGrid(Vector3<float> minIn, Vector3<float> maxIn, int numX, int numY, int numZ)
+    : min(minIn), max(maxIn)
+{
+    size[0] = juce::jmax(1, numX);
+    size[1] = juce::jmax(1, numY);
+    size[2] = juce::jmax(1, numZ);
+    offsets.assign((size_t)getNumCells() + 1, 0);
+}
+
+Vector3<float> ReceiverGrid::getCellCentre(int cell) const
+{
+    int x = cell % size[0];
+    int y = (cell / size[0]) % size[1];
+    int z = cell / (size[0] * size[1]);
+
+    // Cells are spread evenly from min to max inclusive, a single cell sits in the middle
+    auto along = [](float lo, float hi, int index, int count) {
+        return count > 1 ? lo + (hi - lo) * (float)index / (float)(count - 1) : (lo + hi) * 0.5f;
+    };
+
+    return { along(min.x, max.x, x, size[0]), along(min.y, max.y, y, size[1]), along(min.z, max.z, z, size[2]) };
+}
+
+void ReceiverGrid::setCellIRs(const std::vector<SparseIR>& irs)
+{
+    jassert((int)irs.size() == getNumCells());
+
+    taps.clear();
+    offsets.assign((size_t)getNumCells() + 1, 0);
+    for (int cell = 0; cell < getNumCells(); cell++)
+    {
+        offsets[(size_t)cell] = (int)taps.size();
+        if (cell < (int)irs.size())
+            taps.insert(taps.end(), irs[(size_t)cell].begin(), irs[(size_t)cell].end());
+    }
+    offsets.back() = (int)taps.size();
+    taps.shrink_to_fit();
+}
+
+bool ReceiverGrid::setPackedTaps(std::vector<ImpulseTap> packedTaps, std::vector<int> packedOffsets)
+{
+    if ((int)packedOffsets.size() != getNumCells() + 1 || packedOffsets.front() != 0 || packedOffsets.back() != (int)packedTaps.size())
+        return false;
+
+    for (size_t i = 1; i < packedOffsets.size(); i++)
+        if (packedOffsets[i] < packedOffsets[i - 1])
+            return false;
+
+    taps = std::move(packedTaps);
+    offsets = std::move(packedOffsets);
+    return true;
+}
+
+const ImpulseTap* ReceiverGrid::getTaps(int cell, int& numTaps) const
+{
+    numTaps = offsets[(size_t)cell + 1] - offsets[(size_t)cell];
+    return taps.data() + offsets[(size_t)cell];
+}
+
+ReceiverGrid::Blend ReceiverGrid::getBlend(Vector3<float> position) const
+{
+    const float normalised[3] = { position.x, position.y, position.z };
+    int lower[3], upper[3];
+    float fraction[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float g = juce::jlimit(0.0f, 1.0f, normalised[axis]) * (float)(size[axis] - 1);
+        lower[axis] = juce::jmin((int)g, size[axis] - 1);
+        upper[axis] = juce::jmin(lower[axis] + 1, size[axis] - 1);
+        fraction[axis] = g - (float)lower[axis];
+    }
+
+    Blend blend;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        int x = (corner & 1) ? upper[0] : lower[0];
+        int y = (corner & 2) ? upper[1] : lower[1];
+        int z = (corner & 4) ? upper[2] : lower[2];
+        blend.cells[corner] = cellIndex(x, y, z);
+        blend.weights[corner] = ((corner & 1) ? fraction[0] : 1.0f - fraction[0])
+                              * ((corner & 2) ? fraction[1] : 1.0f - fraction[1])
+                              * ((corner & 4) ? fraction[2] : 1.0f - fraction[2]);
+    }
+
+    return blend;
+}
+
+void ReceiverGrid::renderBlend(const Blend& blend, juce::AudioBuffer<float>& buffer, double sampleRate, int numChannels) const
+{
+    int length = 1;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        int numTaps;
+        const ImpulseTap* cellTaps = getTaps(blend.cells[corner], numTaps);
+        if (numTaps > 0 && blend.weights[corner] > 0.0f)
+            length = juce::jmax(length, (int)(cellTaps[numTaps - 1].delay * sampleRate / 1000.0) + 1);
+    }
+
+    buffer.setSize(numChannels, length);
+    buffer.clear();
+
+    for (int corner = 0; corner < 8; corner++)
+    {
+        if (blend.weights[corner] <= 0.0f)
+            continue;
+
+        int numTaps;
+        const ImpulseTap* cellTaps = getTaps(blend.cells[corner], numTaps);
+        renderImpulseResponse(cellTaps, numTaps, buffer, sampleRate, blend.weights[corner]);
+    }
+}
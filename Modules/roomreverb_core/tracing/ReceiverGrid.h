@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+#pragma once
+#include <vector>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "../ir/ImpulseResponse.h"
+#include "../geometry/Vector3.h"
+
+/***************************************************************/
+// A regular 3D grid of receiver positions inside the room, and
+// the sparse IR traced at each. The taps of every cell are
+// packed into one array, indexed by per-cell offsets.
+//
+// Listener positions between cells are handled by blending the
+// IRs of the eight surrounding cells with trilinear weights.
+/***************************************************************/
+class ReceiverGrid
+{
+public:
+    struct Blend {
+        int cells[8];
+        float weights[8];
+    };
+
+    ReceiverGrid() = default;
+    ReceiverGrid(Vector3<float> min, Vector3<float> max, int numX, int numY, int numZ);
+
+    int getNumCells() const { return size[0] * size[1] * size[2]; }
+    Vector3<float> getCellCentre(int cell) const;
+
+    /** Packs the IRs traced for each cell, in cell order. */
+    void setCellIRs(const std::vector<SparseIR>& irs);
+
+    const ImpulseTap* getTaps(int cell, int& numTaps) const;
+
+    // Raw access to the grid's layout and packed taps, for serialisation
+    Vector3<float> getMin() const { return min; }
+    Vector3<float> getMax() const { return max; }
+    int getSize(int axis) const { return size[axis]; }
+    const std::vector<ImpulseTap>& getPackedTaps() const { return taps; }
+    const std::vector<int>& getOffsets() const { return offsets; }
+
+    /** Restores packed taps as returned by getPackedTaps() and getOffsets(). Returns false if they don't fit the grid. */
+    bool setPackedTaps(std::vector<ImpulseTap> packedTaps, std::vector<int> packedOffsets);
+
+    /** Returns the cells and weights for a position given as 0..1 across the grid on each axis. */
+    Blend getBlend(Vector3<float> position) const;
+
+    /** Renders the weighted sum of the blended cell IRs into a buffer sized to fit them. */
+    void renderBlend(const Blend& blend, juce::AudioBuffer<float>& buffer, double sampleRate, int numChannels) const;
+
+private:
+    int cellIndex(int x, int y, int z) const { return (z * size[1] + y) * size[0] + x; }
+
+    Vector3<float> min, max;
+    int size[3] = { 0, 0, 0 };
+    std::vector<ImpulseTap> taps;
+    std::vector<int> offsets; // start of each cell's taps, plus one past the end
+};
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <juce_core/juce_core.h>
+#include "../geometry/SharedData.h"
+#include "TraceResult.h"
+#include "RayPaths.h"
+
+/***************************************************************/
+// One request to trace a scene, shared between whoever submitted
+// it, the scheduler and the tracer.
+//
+// The tracer reports progress and checks for cancellation after
+// every batch of rays; the UI reads the progress and remaining
+// time without taking any locks.
+//
+// A job with a deadline traces progressively: the best IR found
+// so far is published by the deadline, and better ones as the
+// trace goes on, until the final one is passed to onComplete.
+/***************************************************************/
+class TraceJob
+{
+public:
+    using CompletionCallback = std::function<void(std::shared_ptr<const TraceResult>)>;
+
+    TraceJob(std::shared_ptr<const SharedData> sceneToTrace, CompletionCallback callback,
+             double deadlineSeconds = 0.0, CompletionCallback intermediateCallback = nullptr)
+        : scene(std::move(sceneToTrace)), onComplete(std::move(callback)),
+          deadline(deadlineSeconds), onIntermediateResult(std::move(intermediateCallback)) {}
+
+    /** Deadline for interactive edits, short enough to follow the mouse. */
+    static constexpr double interactiveDeadline = 0.15;
+
+    const std::shared_ptr<const SharedData> scene;
+    const CompletionCallback onComplete; // called on the tracing thread, unless the job was cancelled
+
+    const double deadline; // seconds after the start by which a first IR is published, or 0 to only publish the final one
+    const CompletionCallback onIntermediateResult; // called on the tracing thread with each intermediate result
+
+    juce::File traceLogFile;         // if set before the job is submitted, the trace is logged to this file, see TraceLog
+    RayPathRing* rayPaths = nullptr; // if set before the job is submitted, a sample of the traced paths is pushed here for the view
+
+    void cancel() noexcept { cancelled = true; }
+    bool isCancelled() const noexcept { return cancelled; }
+
+    /** Marks the start of tracing, for the remaining time estimate. */
+    void start() noexcept { startTime = juce::Time::getMillisecondCounterHiRes(); }
+    bool isStarted() const noexcept { return startTime > 0.0; }
+
+    void setProgress(float fraction) noexcept { progress = juce::jlimit(0.0f, 1.0f, fraction); }
+    float getProgress() const noexcept { return progress; }
+
+    /** Estimates the time left from the progress so far, or returns a negative value if there isn't enough to go on. */
+    double getSecondsRemaining() const noexcept
+    {
+        float fraction = progress;
+        double started = startTime;
+        if (started <= 0.0 || fraction <= 0.0f)
+            return -1.0;
+
+        double elapsed = (juce::Time::getMillisecondCounterHiRes() - started) / 1000.0;
+        return elapsed * (1.0 - fraction) / fraction;
+    }
+
+private:
+    std::atomic<bool> cancelled{ false };
+    std::atomic<float> progress{ 0.0f };
+    std::atomic<double> startTime{ 0.0 };
+};
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "TraceLog.h"
+
+TraceLog::TraceLog(const juce::File& file, const TraceLogHeader& header) : writer(*this)
+{
+    file.getParentDirectory().createDirectory();
+    file.deleteFile();
+
+    stream = file.createOutputStream();
+    if (stream == nullptr || !stream->write(&header, sizeof(header)))
+    {
+        stream.reset();
+        return;
+    }
+
+    current.reserve(BLOCK_SIZE);
+    writer.startThread();
+}
+
+TraceLog::~TraceLog()
+{
+    if (stream == nullptr)
+        return;
+
+    if (!current.empty())
+        submitBlock();
+
+    // The writer finishes the pending blocks before it exits
+    writer.signalThreadShouldExit();
+    writer.notify();
+    writer.stopThread(-1);
+    stream->flush();
+}
+
+void TraceLog::submitBlock()
+{
+    if (stream == nullptr)
+    {
+        current.clear();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        blockWritten.wait(lock, [this] { return pending.size() < MAX_PENDING_BLOCKS; });
+
+        pending.push_back(std::move(current));
+        if (!spare.empty())
+        {
+            current = std::move(spare.front());
+            spare.pop_front();
+        }
+        else
+        {
+            current = {};
+            current.reserve(BLOCK_SIZE);
+        }
+    }
+
+    writer.notify();
+}
+
+void TraceLog::Writer::run()
+{
+    for (;;)
+    {
+        std::vector<TraceLogRecord> block;
+        {
+            std::lock_guard<std::mutex> lock(log.mutex);
+            if (!log.pending.empty())
+            {
+                block = std::move(log.pending.front());
+                log.pending.pop_front();
+            }
+        }
+
+        if (block.empty())
+        {
+            if (threadShouldExit())
+                return;
+            wait(-1);
+            continue;
+        }
+
+        log.stream->write(block.data(), block.size() * sizeof(TraceLogRecord));
+
+        {
+            std::lock_guard<std::mutex> lock(log.mutex);
+            block.clear();
+            log.spare.push_back(std::move(block));
+        }
+        log.blockWritten.notify_all();
+    }
+}
+
+void TraceLog::addRay(int source, int origin, Vector3<float> direction, int hits)
+{
+    TraceLogRecord record{};
+    record.type = TraceLogFormat::ray;
+    record.source = source;
+    record.index = origin;
+    record.receiver = -1;
+    record.values[0] = direction.x;
+    record.values[1] = direction.y;
+    record.values[2] = direction.z;
+    record.values[3] = (float)hits;
+    add(record);
+}
+
+void TraceLog::addHit(int source, int origin, int receiver, int reflection, float delay, float azimuth, float polar, float weight)
+{
+    TraceLogRecord record{};
+    record.type = TraceLogFormat::hit;
+    record.reflection = (uint16_t)reflection;
+    record.source = source;
+    record.index = origin;
+    record.receiver = receiver;
+    record.values[0] = delay;
+    record.values[1] = azimuth;
+    record.values[2] = polar;
+    record.values[3] = weight;
+    add(record);
+}
+
+void TraceLog::addTaps(int source, int receiver, const ImpulseTap* taps, int numTaps)
+{
+    for (int i = 0; i < numTaps; i++)
+    {
+        TraceLogRecord record{};
+        record.type = TraceLogFormat::tap;
+        record.source = source;
+        record.index = i;
+        record.receiver = receiver;
+        record.values[0] = taps[i].delay;
+        record.values[1] = taps[i].azimuth;
+        record.values[2] = taps[i].elevation;
+        record.values[3] = taps[i].gain;
+        add(record);
+    }
+}
+
+juce::File TraceLog::getFileFromEnvironment(juce::uint64 sceneHash)
+{
+    juce::String directory = juce::SystemStats::getEnvironmentVariable("ROOMREVERB_TRACE_LOG", {});
+    if (directory.isEmpty() || !juce::File::isAbsolutePath(directory))
+        return {};
+
+    return juce::File(directory).getChildFile(juce::String::toHexString((juce::int64)sceneHash).paddedLeft('0', 16)
+        + juce::Time::getCurrentTime().formatted("-%Y%m%d-%H%M%S") + ".rrlog").getNonexistentSibling();
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include "../ir/ImpulseResponse.h"
+#include "TraceLogFormat.h"
+#include "../geometry/Vector3.h"
+
+/***************************************************************/
+// Writes the binary log of one trace, see TraceLogFormat.h.
+//
+// Logging is off unless a job asks for it (TraceJob::traceLogFile),
+// and the tracer only checks a pointer when it is. When it is
+// on, records are copied into blocks which a background thread
+// writes out, so the tracer only waits on the disk if the writer
+// falls a long way behind. Tools/TraceLogToCsv converts logs.
+/***************************************************************/
+class TraceLog
+{
+public:
+    TraceLog(const juce::File& file, const TraceLogHeader& header);
+
+    /** Writes the remaining records and closes the file. */
+    ~TraceLog();
+
+    bool isOpen() const { return stream != nullptr; }
+
+    void add(const TraceLogRecord& record)
+    {
+        current.push_back(record);
+        if (current.size() == BLOCK_SIZE)
+            submitBlock();
+    }
+
+    void addRay(int source, int origin, Vector3<float> direction, int hits);
+    void addHit(int source, int origin, int receiver, int reflection, float delay, float azimuth, float polar, float weight);
+    void addTaps(int source, int receiver, const ImpulseTap* taps, int numTaps);
+
+    /** Returns a new log file in the directory named by the ROOMREVERB_TRACE_LOG environment variable,
+        or File() if it isn't set, which leaves logging off. */
+    static juce::File getFileFromEnvironment(juce::uint64 sceneHash);
+
+private:
+    class Writer : public juce::Thread
+    {
+    public:
+        explicit Writer(TraceLog& owner) : juce::Thread("TraceLog"), log(owner) {}
+        void run() override;
+
+    private:
+        TraceLog& log;
+    };
+
+    void submitBlock();
+
+    static const size_t BLOCK_SIZE = 4096;       // records
+    static const size_t MAX_PENDING_BLOCKS = 64; // 8 MB
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+    std::vector<TraceLogRecord> current;
+
+    std::mutex mutex;
+    std::condition_variable blockWritten;
+    std::deque<std::vector<TraceLogRecord>> pending, spare;
+    Writer writer;
+};
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <cstdint>
+
+/***************************************************************/
+// The layout of a binary trace log, see TraceLog.
+//
+// A log is a TraceLogHeader followed by TraceLogRecords, both
+// fixed size and little-endian, so a log can be read back (or
+// memory-mapped) without parsing. Plain C++ only, so tools can
+// read logs without JUCE.
+/***************************************************************/
+namespace TraceLogFormat
+{
+    const char magic[4] = { 'R', 'R', 'T', 'L' };
+    const uint32_t version = 1;
+
+    enum RecordType : uint8_t {
+        ray = 1, // a traced path: values are the direction (x, y, z) and the receiver hits along it
+        hit = 2, // a new path to a receiver: values are the delay (ms), azimuth, polar angle and weight
+        tap = 3  // a tap of a final IR: values are the delay (ms), azimuth and elevation buckets, and gain
+    };
+}
+
+// The scene the log was traced from
+struct TraceLogHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sceneHash;
+    float roomSize[3], roomPos[3];
+    float listenerPos[3], listenerSize[3];
+    float speedOfSound, rollOff, delayBucketSize, refinementTolerance;
+    int32_t numSources, numReceivers, numReflections;
+    int32_t additionalRays, numberPolarBuckets, maxRefinementRounds;
+    int32_t receiverGrid[3];
+    int32_t reserved[3];
+};
+
+struct TraceLogRecord {
+    uint8_t type;        // TraceLogFormat::RecordType
+    uint8_t reserved;
+    uint16_t reflection; // hits: the reflection the receiver was hit after
+    int32_t source;
+    int32_t index;       // rays and hits: the pass 1 ray the path came from; taps: position in the IR
+    int32_t receiver;    // hits and taps: 0 is the listener, then the cells of the receiver grid
+    float values[4];
+};
+
+static_assert(sizeof(TraceLogHeader) == 128, "The trace log header is written as is");
+static_assert(sizeof(TraceLogRecord) == 32, "Trace log records are written as is");
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "TraceResult.h"
+#include "../geometry/SharedData.h"
+
+namespace
+{
+    // Taps are stored as raw structs
+    static_assert(sizeof(ImpulseTap) == 4 * sizeof(float), "ImpulseTap must stay a plain block of floats");
+
+    // Bounds-checked reads from memory
+    struct Reader
+    {
+        const char* data;
+        size_t size, position = 0;
+
+        template <typename T>
+        bool read(T& value)
+        {
+            if (size - position < sizeof(T))
+                return false;
+
+            memcpy(&value, data + position, sizeof(T));
+            position += sizeof(T);
+            return true;
+        }
+
+        template <typename T>
+        bool readArray(std::vector<T>& values)
+        {
+            juce::uint32 count;
+            if (!read(count) || (size - position) / sizeof(T) < count)
+                return false;
+
+            values.resize(count);
+            memcpy(values.data(), data + position, count * sizeof(T));
+            position += count * sizeof(T);
+            return true;
+        }
+    };
+
+    template <typename T>
+    void writeValue(juce::OutputStream& stream, const T& value)
+    {
+        stream.write(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(juce::OutputStream& stream, const std::vector<T>& values)
+    {
+        writeValue(stream, (juce::uint32)values.size());
+        stream.write(values.data(), values.size() * sizeof(T));
+    }
+}
+
+void writeTraceResult(juce::OutputStream& stream, const TraceResult& result)
+{
+    writeValue(stream, (juce::uint32)result.sources.size());
+    for (auto& sourceResult : result.sources)
+    {
+        writeArray(stream, sourceResult.listenerIR);
+        writeValue(stream, (juce::uint32)(sourceResult.receiverGrid != nullptr ? 1 : 0));
+
+        if (auto& grid = sourceResult.receiverGrid)
+        {
+            auto min = grid->getMin();
+            auto max = grid->getMax();
+            const float bounds[6] = { min.x, min.y, min.z, max.x, max.y, max.z };
+            const int size[3] = { grid->getSize(0), grid->getSize(1), grid->getSize(2) };
+            writeValue(stream, bounds);
+            writeValue(stream, size);
+            writeArray(stream, grid->getPackedTaps());
+            writeArray(stream, grid->getOffsets());
+        }
+    }
+}
+
+std::shared_ptr<TraceResult> readTraceResult(const void* data, size_t size)
+{
+    Reader reader{ static_cast<const char*>(data), size };
+
+    juce::uint32 numSources;
+    if (!reader.read(numSources))
+        return nullptr;
+
+    auto result = std::make_shared<TraceResult>();
+    for (juce::uint32 source = 0; source < numSources; source++)
+    {
+        SourceResult sourceResult;
+        juce::uint32 hasGrid;
+        if (!reader.readArray(sourceResult.listenerIR) || !reader.read(hasGrid))
+            return nullptr;
+
+        if (hasGrid != 0)
+        {
+            float bounds[6];
+            int gridSize[3];
+            std::vector<ImpulseTap> taps;
+            std::vector<int> offsets;
+            if (!reader.read(bounds) || !reader.read(gridSize) || !reader.readArray(taps) || !reader.readArray(offsets))
+                return nullptr;
+
+            // The grid allocates a cell per offset, so check its size before trusting it
+            size_t numCells = 1;
+            for (int cells : gridSize)
+            {
+                if (cells < 1 || cells > SharedData::Limits::receiverGridSize)
+                    return nullptr;
+                numCells *= (size_t)cells;
+            }
+
+            if (offsets.empty() || numCells != offsets.size() - 1)
+                return nullptr;
+
+            auto grid = std::make_shared<ReceiverGrid>(Vector3<float>(bounds[0], bounds[1], bounds[2]),
+                                                       Vector3<float>(bounds[3], bounds[4], bounds[5]),
+                                                       gridSize[0], gridSize[1], gridSize[2]);
+            if (!grid->setPackedTaps(std::move(taps), std::move(offsets)))
+                return nullptr;
+
+            sourceResult.receiverGrid = std::move(grid);
+        }
+
+        result->sources.push_back(std::move(sourceResult));
+    }
+
+    return result;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <memory>
+#include <vector>
+#include "../ir/ImpulseResponse.h"
+#include "ReceiverGrid.h"
+#include <juce_core/juce_core.h>
+
+// What a trace produces for each sound source: the listener's IR, and the receiver grid's IRs if enabled
+struct SourceResult {
+    SparseIR listenerIR;
+    std::shared_ptr<const ReceiverGrid> receiverGrid;
+};
+
+struct TraceResult {
+    std::vector<SourceResult> sources;
+    juce::uint64 sceneHash = 0; // hash of the scene traced, see IRCache::hashScene()
+    bool complete = true;       // false for the intermediate results of a progressive trace
+};
+
+/** Writes the taps of every source in a compact binary layout. The scene hash is not included. */
+void writeTraceResult(juce::OutputStream& stream, const TraceResult& result);
+
+/** Reads a result written by writeTraceResult() from memory, or returns nullptr if it is malformed. */
+std::shared_ptr<TraceResult> readTraceResult(const void* data, size_t size);
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "GoldenIR.h"
+#include "../tracing/IRCache.h"
+
+namespace
+{
+    const char GOLDEN_MAGIC[4] = { 'R', 'R', 'G', 'I' };
+    const juce::uint32 GOLDEN_VERSION = 1;
+
+    // Hashed like the IR cache's keys, without an engine version, so goldens outlive engine changes
+    juce::uint64 hashGoldenScene(const SharedData& scene)
+    {
+        return IRCache::hashScene(scene, 0);
+    }
+
+    SparseIR getCellIR(const ReceiverGrid& grid, int cell)
+    {
+        int numTaps;
+        const ImpulseTap* taps = grid.getTaps(cell, numTaps);
+        return SparseIR(taps, taps + numTaps);
+    }
+}
+
+bool GoldenIR::write(const juce::File& file, const SharedData& scene, const TraceResult& result)
+{
+    juce::MemoryOutputStream stream;
+    stream.write(GOLDEN_MAGIC, sizeof(GOLDEN_MAGIC));
+    stream.writeInt((int)GOLDEN_VERSION);
+    stream.writeInt64((juce::int64)hashGoldenScene(scene));
+    writeTraceResult(stream, result);
+
+    return file.getParentDirectory().createDirectory() && file.replaceWithData(stream.getData(), stream.getDataSize());
+}
+
+std::shared_ptr<TraceResult> GoldenIR::read(const juce::File& file, const SharedData& scene, juce::String& error)
+{
+    juce::MemoryBlock data;
+    if (!file.loadFileAsData(data))
+    {
+        error = "no golden result " + file.getFileName();
+        return nullptr;
+    }
+
+    const size_t headerSize = sizeof(GOLDEN_MAGIC) + sizeof(juce::uint32) + sizeof(juce::uint64);
+    juce::MemoryInputStream stream(data, false);
+    char magic[4] = {};
+    if (data.getSize() < headerSize || stream.read(magic, sizeof(magic)) != (int)sizeof(magic)
+        || memcmp(magic, GOLDEN_MAGIC, sizeof(magic)) != 0 || (juce::uint32)stream.readInt() != GOLDEN_VERSION)
+    {
+        error = file.getFileName() + " is not a version " + juce::String((int)GOLDEN_VERSION) + " golden result";
+        return nullptr;
+    }
+
+    if ((juce::uint64)stream.readInt64() != hashGoldenScene(scene))
+    {
+        error = file.getFileName() + " was traced from a different scene";
+        return nullptr;
+    }
+
+    auto golden = readTraceResult(static_cast<const char*>(data.getData()) + headerSize, data.getSize() - headerSize);
+    if (golden == nullptr)
+        error = file.getFileName() + " is damaged";
+
+    return golden;
+}
+
+IRComparison GoldenIR::compare(const TraceResult& golden, const TraceResult& result, const IRComparison::Settings& settings)
+{
+    IRComparison worst;
+    if (golden.sources.size() != result.sources.size())
+    {
+        worst.energyMatched = 0.0f;
+        worst.extraEnergy = 1.0f;
+        return worst;
+    }
+
+    for (size_t source = 0; source < golden.sources.size(); source++)
+    {
+        auto& goldenSource = golden.sources[source];
+        auto& resultSource = result.sources[source];
+        worst.mergeWorst(IRComparison::compare(goldenSource.listenerIR, resultSource.listenerIR, settings));
+
+        if ((goldenSource.receiverGrid == nullptr) != (resultSource.receiverGrid == nullptr)
+            || (goldenSource.receiverGrid != nullptr && goldenSource.receiverGrid->getNumCells() != resultSource.receiverGrid->getNumCells()))
+        {
+            worst.energyMatched = 0.0f;
+            worst.extraEnergy = 1.0f;
+            continue;
+        }
+
+        if (goldenSource.receiverGrid != nullptr)
+            for (int cell = 0; cell < goldenSource.receiverGrid->getNumCells(); cell++)
+                worst.mergeWorst(IRComparison::compare(getCellIR(*goldenSource.receiverGrid, cell), getCellIR(*resultSource.receiverGrid, cell), settings));
+    }
+
+    return worst;
+}
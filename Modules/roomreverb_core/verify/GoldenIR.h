@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <memory>
+#include <juce_core/juce_core.h>
+#include "IRComparison.h"
+#include "../geometry/SharedData.h"
+#include "../tracing/TraceResult.h"
+
+/***************************************************************/
+// Golden results: what the engine traced for a scene when it was
+// last known to sound right, kept to catch changes to the tracer
+// that change the sound without meaning to.
+//
+// The tracer seeds its random numbers the same way for every
+// trace, so an unchanged engine reproduces a golden result
+// exactly, on any number of threads; a comparison only shows
+// differences once the engine changes. A golden file holds the
+// hash of the scene it was traced from, without the engine
+// version, so a stale golden for an edited scene is reported
+// rather than compared.
+/***************************************************************/
+namespace GoldenIR
+{
+    /** Writes the result traced for the scene. Returns false if the file couldn't be written. */
+    bool write(const juce::File& file, const SharedData& scene, const TraceResult& result);
+
+    /** Reads the golden result for the scene, or returns nullptr and why if there isn't one. */
+    std::shared_ptr<TraceResult> read(const juce::File& file, const SharedData& scene, juce::String& error);
+
+    /** Compares every source at every receiver, keeping the worst of each metric. */
+    IRComparison compare(const TraceResult& golden, const TraceResult& result, const IRComparison::Settings& settings);
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "IRComparison.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <juce_dsp/juce_dsp.h>
+
+namespace
+{
+    const float MIN_LEVEL_DB = -200.0f; // level of silence, so empty bands and curves still compare
+
+    float toDecibels(double energy)
+    {
+        return energy > 0.0 ? juce::jmax(MIN_LEVEL_DB, (float)(10.0 * std::log10(energy))) : MIN_LEVEL_DB;
+    }
+}
+
+IRComparison IRComparison::compare(const SparseIR& reference, const SparseIR& test, const Settings& settings)
+{
+    IRComparison comparison;
+    comparison.referenceTaps = (int)reference.size();
+    comparison.testTaps = (int)test.size();
+
+    // Pair the taps, loudest reference taps first so they get the nearest test taps
+    std::vector<size_t> order(reference.size());
+    std::iota(order.begin(), order.end(), (size_t)0);
+    std::stable_sort(order.begin(), order.end(), [&reference](size_t a, size_t b) { return std::abs(reference[a].gain) > std::abs(reference[b].gain); });
+
+    std::vector<bool> paired(test.size(), false);
+    double referenceEnergy = 0.0, matchedEnergy = 0.0, levelError = 0.0, levelWeight = 0.0;
+    const float tolerance = settings.tapTimeToleranceMs;
+
+    for (size_t r : order)
+    {
+        const ImpulseTap& tap = reference[r];
+        double energy = (double)tap.gain * tap.gain;
+        referenceEnergy += energy;
+
+        // Both IRs are sorted by delay
+        auto candidate = std::lower_bound(test.begin(), test.end(), tap.delay - tolerance,
+                                          [](const ImpulseTap& testTap, float delay) { return testTap.delay < delay; });
+        size_t best = test.size();
+        for (; candidate != test.end() && candidate->delay <= tap.delay + tolerance; ++candidate)
+        {
+            size_t t = (size_t)(candidate - test.begin());
+            if (paired[t] || (candidate->gain < 0.0f) != (tap.gain < 0.0f))
+                continue;
+            if (settings.matchDirections && (candidate->azimuth != tap.azimuth || candidate->elevation != tap.elevation))
+                continue;
+            if (best == test.size() || std::abs(candidate->delay - tap.delay) < std::abs(test[best].delay - tap.delay))
+                best = t;
+        }
+
+        if (best == test.size())
+            continue;
+
+        paired[best] = true;
+        comparison.matchedTaps++;
+        matchedEnergy += energy;
+        comparison.maxDelayErrorMs = juce::jmax(comparison.maxDelayErrorMs, std::abs(test[best].delay - tap.delay));
+
+        if (tap.gain != 0.0f && test[best].gain != 0.0f)
+        {
+            double difference = 20.0 * std::log10(std::abs(test[best].gain / tap.gain));
+            levelError += energy * difference * difference;
+            levelWeight += energy;
+        }
+    }
+
+    double testEnergy = 0.0, extraEnergy = 0.0;
+    for (size_t t = 0; t < test.size(); t++)
+    {
+        double energy = (double)test[t].gain * test[t].gain;
+        testEnergy += energy;
+        if (!paired[t])
+            extraEnergy += energy;
+    }
+
+    comparison.energyMatched = referenceEnergy > 0.0 ? (float)(matchedEnergy / referenceEnergy) : (testEnergy > 0.0 ? 0.0f : 1.0f);
+    comparison.extraEnergy = testEnergy > 0.0 ? (float)(extraEnergy / testEnergy) : 0.0f;
+    comparison.tapLevelErrorDb = levelWeight > 0.0 ? (float)std::sqrt(levelError / levelWeight) : 0.0f;
+
+    // Render both to compare how they sound
+    int numSamples = juce::jmax(getImpulseResponseLength(reference, settings.sampleRate), getImpulseResponseLength(test, settings.sampleRate));
+    if (numSamples == 0)
+        return comparison;
+
+    juce::AudioBuffer<float> referenceIR(1, numSamples), testIR(1, numSamples);
+    referenceIR.clear();
+    testIR.clear();
+    renderImpulseResponse(reference, referenceIR, settings.sampleRate);
+    renderImpulseResponse(test, testIR, settings.sampleRate);
+
+    auto referenceEDC = getEnergyDecayCurve(referenceIR);
+    auto testEDC = getEnergyDecayCurve(testIR);
+    for (int i = 0; i < numSamples; i++)
+    {
+        float referenceLevel = juce::jmax(referenceEDC[(size_t)i], settings.edcFloorDb);
+        float testLevel = juce::jmax(testEDC[(size_t)i], settings.edcFloorDb);
+        comparison.edcErrorDb = juce::jmax(comparison.edcErrorDb, std::abs(referenceLevel - testLevel));
+    }
+
+    // Long enough for a few bins in the lowest band
+    int fftSize = juce::jmax(32768, juce::nextPowerOfTwo(numSamples));
+    auto referenceBands = getThirdOctaveLevels(referenceIR, settings.sampleRate, fftSize);
+    auto testBands = getThirdOctaveLevels(testIR, settings.sampleRate, fftSize);
+    double bandError = 0.0;
+    for (size_t band = 0; band < referenceBands.size(); band++)
+        bandError += (double)(referenceBands[band] - testBands[band]) * (referenceBands[band] - testBands[band]);
+    if (!referenceBands.empty())
+        comparison.spectralDistanceDb = (float)std::sqrt(bandError / (double)referenceBands.size());
+
+    return comparison;
+}
+
+void IRComparison::mergeWorst(const IRComparison& other)
+{
+    referenceTaps += other.referenceTaps;
+    testTaps += other.testTaps;
+    matchedTaps += other.matchedTaps;
+    energyMatched = juce::jmin(energyMatched, other.energyMatched);
+    extraEnergy = juce::jmax(extraEnergy, other.extraEnergy);
+    tapLevelErrorDb = juce::jmax(tapLevelErrorDb, other.tapLevelErrorDb);
+    maxDelayErrorMs = juce::jmax(maxDelayErrorMs, other.maxDelayErrorMs);
+    edcErrorDb = juce::jmax(edcErrorDb, other.edcErrorDb);
+    spectralDistanceDb = juce::jmax(spectralDistanceDb, other.spectralDistanceDb);
+}
+
+bool IRComparison::passes(const Tolerances& tolerances, juce::String& failures) const
+{
+    juce::StringArray failed;
+    if (energyMatched < tolerances.minEnergyMatched)
+        failed.add("energy matched " + juce::String(energyMatched, 4) + " < " + juce::String(tolerances.minEnergyMatched, 4));
+    if (extraEnergy > tolerances.maxExtraEnergy)
+        failed.add("extra energy " + juce::String(extraEnergy, 4) + " > " + juce::String(tolerances.maxExtraEnergy, 4));
+    if (tapLevelErrorDb > tolerances.maxTapLevelErrorDb)
+        failed.add("tap level error " + juce::String(tapLevelErrorDb, 2) + " dB > " + juce::String(tolerances.maxTapLevelErrorDb, 2) + " dB");
+    if (edcErrorDb > tolerances.maxEdcErrorDb)
+        failed.add("EDC error " + juce::String(edcErrorDb, 2) + " dB > " + juce::String(tolerances.maxEdcErrorDb, 2) + " dB");
+    if (spectralDistanceDb > tolerances.maxSpectralDistanceDb)
+        failed.add("spectral distance " + juce::String(spectralDistanceDb, 2) + " dB > " + juce::String(tolerances.maxSpectralDistanceDb, 2) + " dB");
+
+    failures = failed.joinIntoString(", ");
+    return failed.isEmpty();
+}
+
+std::vector<float> IRComparison::getEnergyDecayCurve(const juce::AudioBuffer<float>& ir)
+{
+    // The same integration as the decay length the convolvers report, see getDecayLength()
+    auto remaining = getRemainingEnergy(ir);
+    double total = remaining.empty() ? 0.0 : remaining.front();
+
+    std::vector<float> curve(remaining.size());
+    for (size_t i = 0; i < remaining.size(); i++)
+        curve[i] = total > 0.0 ? toDecibels(remaining[i] / total) : MIN_LEVEL_DB;
+
+    return curve;
+}
+
+std::vector<float> IRComparison::getThirdOctaveLevels(const juce::AudioBuffer<float>& ir, double sampleRate, int fftSize)
+{
+    std::vector<float> data((size_t)(2 * fftSize), 0.0f);
+    memcpy(data.data(), ir.getReadPointer(0), sizeof(float) * (size_t)juce::jmin(fftSize, ir.getNumSamples()));
+
+    juce::dsp::FFT fft(juce::roundToInt(std::log2((double)fftSize)));
+    fft.performFrequencyOnlyForwardTransform(data.data());
+
+    std::vector<float> levels;
+    const double binWidth = sampleRate / fftSize;
+    const double halfBand = std::pow(2.0, 1.0 / 6.0);
+    for (int band = -12; band <= 12; band++) // 63 Hz to 16 kHz around 1 kHz
+    {
+        double centre = 1000.0 * std::pow(2.0, band / 3.0);
+        if (centre * halfBand >= sampleRate / 2.0)
+            break;
+
+        int first = (int)std::ceil(centre / halfBand / binWidth);
+        int last = (int)std::floor(centre * halfBand / binWidth);
+        double energy = 0.0;
+        for (int bin = first; bin <= last; bin++)
+            energy += (double)data[(size_t)bin] * data[(size_t)bin];
+
+        levels.push_back(toDecibels(energy));
+    }
+
+    return levels;
+}
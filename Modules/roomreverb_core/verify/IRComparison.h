@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "../ir/ImpulseResponse.h"
+
+/***************************************************************/
+// How far a traced IR is from a reference one: a golden IR the
+// engine produced before a change, or the exact image source
+// IR of a shoebox room.
+//
+// The taps are paired first: each reference tap, loudest first,
+// with the nearest unpaired test tap of the same polarity within
+// Settings::tapTimeToleranceMs (and in the same direction bucket
+// unless directions are ignored). Both IRs are then rendered,
+// and their energy decay curves and third octave band levels
+// compared, so taps that moved or merged but sound the same
+// don't count for much.
+/***************************************************************/
+struct IRComparison {
+    struct Settings {
+        double sampleRate = 48000.0;     // both IRs are rendered at this rate
+        float tapTimeToleranceMs = 0.05f; // furthest apart two taps can be and still be the same reflection
+        bool matchDirections = true;      // whether paired taps must share their direction buckets
+        float edcFloorDb = -60.0f;        // the decay curves are compared down to here
+    };
+
+    // What a comparison has to stay within to pass
+    struct Tolerances {
+        float minEnergyMatched = 0.995f;
+        float maxExtraEnergy = 0.005f;
+        float maxTapLevelErrorDb = 0.5f;
+        float maxEdcErrorDb = 0.5f;
+        float maxSpectralDistanceDb = 0.5f;
+    };
+
+    int referenceTaps = 0, testTaps = 0, matchedTaps = 0;
+    float energyMatched = 1.0f;      // share of the reference's energy in taps the test has too
+    float extraEnergy = 0.0f;        // share of the test's energy in taps the reference doesn't have
+    float tapLevelErrorDb = 0.0f;    // RMS level difference of the paired taps, weighted by their energy in the reference
+    float maxDelayErrorMs = 0.0f;    // largest delay difference of a pair
+    float edcErrorDb = 0.0f;         // largest difference of the energy decay curves, down to Settings::edcFloorDb
+    float spectralDistanceDb = 0.0f; // RMS difference of the third octave band levels
+
+    static IRComparison compare(const SparseIR& reference, const SparseIR& test, const Settings& settings);
+
+    /** Keeps the worse of each metric, to sum up the receivers of a source or the sources of a scene. */
+    void mergeWorst(const IRComparison& other);
+
+    /** Returns true if every metric is within the tolerances, or false and which ones aren't. */
+    bool passes(const Tolerances& tolerances, juce::String& failures) const;
+
+    /** The energy decay curve of every sample of a mono IR, in dB below its total energy, see getRemainingEnergy(). */
+    static std::vector<float> getEnergyDecayCurve(const juce::AudioBuffer<float>& ir);
+
+    /** The energy of a mono IR in third octave bands from 63 Hz up to 16 kHz or near Nyquist, in dB. */
+    static std::vector<float> getThirdOctaveLevels(const juce::AudioBuffer<float>& ir, double sampleRate, int fftSize);
+};
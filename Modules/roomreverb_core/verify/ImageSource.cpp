@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "ImageSource.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include "../geometry/Spherical.h"
+#include "../tracing/ProcessReflections.h"
+
+namespace
+{
+    // Where a ray from origin enters the box, or -1 if it misses
+    float boxEntryDistance(Vector3<float> origin, Vector3<float> direction, Vector3<float> boxMin, Vector3<float> boxMax)
+    {
+        float tEnter = -FLT_MAX, tExit = FLT_MAX;
+        const float o[3] = { origin.x, origin.y, origin.z };
+        const float d[3] = { direction.x, direction.y, direction.z };
+        const float lo[3] = { boxMin.x, boxMin.y, boxMin.z };
+        const float hi[3] = { boxMax.x, boxMax.y, boxMax.z };
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (d[axis] == 0.0f)
+            {
+                if (o[axis] < lo[axis] || o[axis] > hi[axis])
+                    return -1.0f;
+                continue;
+            }
+
+            float t0 = (lo[axis] - o[axis]) / d[axis];
+            float t1 = (hi[axis] - o[axis]) / d[axis];
+            tEnter = juce::jmax(tEnter, juce::jmin(t0, t1));
+            tExit = juce::jmin(tExit, juce::jmax(t0, t1));
+        }
+
+        return tEnter <= tExit && tExit > 0.0f ? juce::jmax(0.0f, tEnter) : -1.0f;
+    }
+
+    // The image of a coordinate in [low, low + size] after reflecting off the walls n times along that axis
+    float imageCoordinate(float position, float low, float size, int n)
+    {
+        float offset = position - low;
+        return low + (float)n * size + (n % 2 == 0 ? offset : size - offset);
+    }
+
+}
+
+bool isShoeboxRoom(const SharedData& scene)
+{
+    const SharedData box;
+    return scene.walls == box.walls && scene.floor == box.floor && scene.ceiling == box.ceiling;
+}
+
+SparseIR traceImageSources(const SharedData& scene, int source)
+{
+    jassert(isShoeboxRoom(scene));
+
+    const Vector3<float> roomMin = scene.roomPos - scene.roomSize * 0.5f;
+    const Vector3<float> boxMin = scene.listenerPos - scene.listenerSize * 0.5f;
+    const Vector3<float> boxMax = scene.listenerPos + scene.listenerSize * 0.5f;
+    const Vector3<float> position = scene.soundSourcePositions[(size_t)source];
+    const int numBuckets = scene.numberPolarBuckets;
+
+    // The tracer's last receiver hits come on the segment after numReflections - 2 reflections
+    const int maxReflections = scene.numReflections - 2;
+
+    std::map<TapKey, float> taps; // the tracer's keys, see ProcessReflections::addTap()
+    for (int nx = -maxReflections; nx <= maxReflections; nx++)
+    {
+        int yRange = maxReflections - std::abs(nx);
+        for (int ny = -yRange; ny <= yRange; ny++)
+        {
+            int zRange = yRange - std::abs(ny);
+            for (int nz = -zRange; nz <= zRange; nz++)
+            {
+                Vector3<float> image(imageCoordinate(position.x, roomMin.x, scene.roomSize.x, nx),
+                                     imageCoordinate(position.y, roomMin.y, scene.roomSize.y, ny),
+                                     imageCoordinate(position.z, roomMin.z, scene.roomSize.z, nz));
+                Vector3<float> direction = (scene.listenerPos - image).normalised();
+                float distance = boxEntryDistance(image, direction, boxMin, boxMax);
+                if (distance < 0.0f)
+                    continue;
+
+                int reflections = std::abs(nx) + std::abs(ny) + std::abs(nz);
+                float delayMs = distance * 1000.0f / scene.speedOfSound;
+
+                // As ProcessReflections::tracePath() and addTap()
+                Cartesian dirC(direction.x, -direction.z, -direction.y);
+                Spherical dirS = dirC.car_to_sph();
+
+                float delay = std::ceil(delayMs * 100.0f) / (scene.delayBucketSize * 100.0f);
+                float attenuation = 1.0f / std::pow(delay, scene.rollOff);
+                float polarity = reflections % 2 == 0 ? 1.0f : -1.0f;
+
+                TapKey key{ delay,
+                            std::ceil(dirS.get_theta() * numBuckets / juce::MathConstants<float>::pi),
+                            std::ceil(dirS.get_phi() * numBuckets / juce::MathConstants<float>::pi) };
+                taps[key] += polarity * attenuation;
+            }
+        }
+    }
+
+    // As ProcessReflections::buildSparseIR()
+    SparseIR ir;
+    ir.reserve(taps.size());
+    float maxValue = 0.0f;
+    for (auto& [key, gain] : taps)
+    {
+        ir.push_back({ key.delay, key.azimuth, key.elevation, gain });
+        maxValue = juce::jmax(maxValue, std::abs(gain));
+    }
+
+    for (auto& tap : ir)
+    {
+        if (maxValue > 0.0f) tap.gain /= maxValue;
+        tap.delay *= scene.delayBucketSize;
+    }
+
+    return ir;
+}
+
+IRComparison::Settings getImageSourceSettings(const SharedData& scene)
+{
+    IRComparison::Settings settings;
+    settings.tapTimeToleranceMs = scene.listenerSize.length() * 1000.0f / scene.speedOfSound;
+    settings.matchDirections = false;
+    settings.edcFloorDb = -30.0f;
+    return settings;
+}
+
+IRComparison::Tolerances getImageSourceTolerances()
+{
+    IRComparison::Tolerances tolerances;
+    tolerances.minEnergyMatched = 0.9f;
+    tolerances.maxExtraEnergy = 1.0f;
+    tolerances.maxTapLevelErrorDb = 1.0f;
+    tolerances.maxEdcErrorDb = 6.0f;
+    tolerances.maxSpectralDistanceDb = 4.0f;
+    return tolerances;
+}
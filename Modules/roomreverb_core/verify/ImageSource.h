@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include "../geometry/SharedData.h"
+#include "../ir/ImpulseResponse.h"
+#include "IRComparison.h"
+
+/***************************************************************/
+// The exact IR of a shoebox room, from its image sources, to
+// check the tracer against (see IRComparison).
+//
+// Every path of up to the tracer's number of reflections is
+// found, and turned into a tap the way the tracer does it: the
+// delay to where the path enters the listener box, the same
+// delay buckets, distance roll-off, polarity per reflection and
+// direction buckets, normalised to a peak of 1. What's left to
+// differ is the paths the tracer misses, and where on the box
+// each one it finds arrives.
+/***************************************************************/
+
+/** Returns true if the scene's room is the plain box SharedData starts with, which the image sources model exactly. */
+bool isShoeboxRoom(const SharedData& scene);
+
+/** Returns the listener IR of one source of a shoebox room. */
+SparseIR traceImageSources(const SharedData& scene, int source);
+
+/** How a traced IR is compared with the image source one: by delay alone, within the time sound takes across the
+    listener box, and the decay curves down to -30 dB, past which the tracer's sparse late paths dominate. */
+IRComparison::Settings getImageSourceSettings(const SharedData& scene);
+
+/** What a traced IR is expected to stay within of the image source one, for scenes traced densely enough.
+    Extra taps aren't held against the tracer: its listener is a box, which paths reach by more orders of
+    surfaces than they reach a point. */
+IRComparison::Tolerances getImageSourceTolerances();
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <atomic>
+#include <JuceHeader.h>
+
+/***************************************************************/
+// Decides when the room view needs a new frame.
+//
+// The view only renders after something has marked it out of
+// date: camera input, a new scene snapshot or trace progress.
+// Frame counts and times are kept so the idle cost of the editor
+// can be checked; they can be read from any thread.
+/***************************************************************/
+class FrameScheduler
+{
+public:
+    /** Marks the view out of date. Returns true if it was up to date, so a repaint needs to be requested. */
+    bool invalidate() noexcept { return !dirty.exchange(true); }
+    bool isDirty() const noexcept { return dirty; }
+
+    /** Call on the rendering thread around each frame. */
+    void beginFrame() noexcept
+    {
+        dirty = false;
+        frameStartTime = juce::Time::getMillisecondCounterHiRes();
+    }
+
+    void endFrame() noexcept
+    {
+        double frameTime = juce::Time::getMillisecondCounterHiRes() - frameStartTime;
+        lastFrameTime = frameTime;
+        totalFrameTime = totalFrameTime + frameTime;
+        framesRendered++;
+    }
+
+    juce::int64 getFramesRendered() const noexcept { return framesRendered; }
+    double getLastFrameTime() const noexcept { return lastFrameTime; } // ms
+
+    double getAverageFrameTime() const noexcept // ms
+    {
+        auto frames = framesRendered.load();
+        return frames > 0 ? totalFrameTime / (double)frames : 0.0;
+    }
+
+private:
+    std::atomic<bool> dirty{ false };
+    std::atomic<juce::int64> framesRendered{ 0 };
+    std::atomic<double> lastFrameTime{ 0.0 }, totalFrameTime{ 0.0 };
+    double frameStartTime = 0.0;
+};
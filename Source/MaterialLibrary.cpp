@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "MaterialLibrary.h"
+
+namespace
+{
+    const char bakedMagic[4] = { 'R', 'R', 'T', 'X' };
+    const juce::uint32 bakedFormatVersion = 1;
+    const char* bakedExtension = ".rrtex";
+
+    // FNV-1a over the encoded image, so a changed asset is baked again
+    juce::uint64 hashSource(const void* data, size_t size)
+    {
+        juce::uint64 hash = 14695981039346656037ULL;
+        auto* bytes = static_cast<const juce::uint8*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+MaterialLibrary::MaterialLibrary() : MaterialLibrary(getDefaultDirectory()) {}
+
+MaterialLibrary::MaterialLibrary(const juce::File& bakedDirectory) : directory(bakedDirectory), decoder(*this)
+{
+    decoder.startThread();
+}
+
+MaterialLibrary::~MaterialLibrary()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+    }
+
+    decoder.stopThread(4000);
+}
+
+juce::File MaterialLibrary::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("RoomReverb")
+        .getChildFile("Materials");
+}
+
+void MaterialLibrary::request(const void* owner, const juce::String& name, const void* data, size_t size, Callback callback)
+{
+    std::shared_ptr<const MaterialTexture> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto found = materials.find(name);
+        if (found != materials.end())
+        {
+            ready = found->second;
+        }
+        else
+        {
+            Request entry;
+            entry.owner = owner;
+            entry.name = name;
+            entry.data = data;
+            entry.size = size;
+            entry.callback = std::move(callback);
+            queue.push_back(std::move(entry));
+        }
+    }
+
+    if (ready != nullptr)
+        callback(ready);
+    else
+        decoder.notify();
+}
+
+void MaterialLibrary::cancelRequests(const void* owner)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    queue.erase(std::remove_if(queue.begin(), queue.end(), [owner](const Request& r) { return r.owner == owner; }), queue.end());
+
+    // The callback calls back into its owner, so it has to finish before the owner goes away
+    callbackFinished.wait(lock, [this, owner] { return runningOwner != owner; });
+}
+
+void MaterialLibrary::Decoder::run()
+{
+    while (!threadShouldExit())
+    {
+        Request request;
+        {
+            std::lock_guard<std::mutex> lock(library.mutex);
+            if (!library.queue.empty())
+            {
+                request = std::move(library.queue.front());
+                library.queue.pop_front();
+                library.runningOwner = request.owner;
+            }
+        }
+
+        if (request.callback == nullptr)
+        {
+            wait(-1);
+            continue;
+        }
+
+        auto texture = library.load(request);
+        if (texture != nullptr)
+            request.callback(texture);
+
+        {
+            std::lock_guard<std::mutex> lock(library.mutex);
+            library.runningOwner = nullptr;
+        }
+        library.callbackFinished.notify_all();
+    }
+}
+
+/***************************************************************/
+// Materials already decoded by an earlier request are reused,
+// then baked ones; only if neither is there is the image decoded.
+/***************************************************************/
+std::shared_ptr<const MaterialTexture> MaterialLibrary::load(const Request& request)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = materials.find(request.name);
+        if (found != materials.end())
+            return found->second;
+    }
+
+    juce::uint64 sourceHash = hashSource(request.data, request.size);
+    juce::File bakedFile = getBakedFile(request.name);
+
+    auto texture = readBaked(bakedFile, sourceHash);
+    if (texture == nullptr)
+    {
+        texture = decode(request.name, request.data, request.size);
+        if (texture == nullptr)
+            return nullptr;
+
+        writeBaked(bakedFile, sourceHash, *texture);
+    }
+    texture->name = request.name;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return materials.emplace(request.name, std::move(texture)).first->second;
+}
+
+std::shared_ptr<MaterialTexture> MaterialLibrary::decode(const juce::String& name, const void* data, size_t size)
+{
+    juce::Image image = juce::ImageFileFormat::loadFrom(data, size);
+    if (image.isNull())
+        return nullptr;
+
+    image = image.convertedToFormat(juce::Image::ARGB);
+
+    auto texture = std::make_shared<MaterialTexture>();
+    texture->name = name;
+
+    MaterialTexture::Level level;
+    level.width = image.getWidth();
+    level.height = image.getHeight();
+    level.pixels.resize((size_t)level.width * (size_t)level.height * 4);
+
+    // Flipped vertically, as OpenGL starts from the bottom row
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readOnly);
+    size_t rowSize = (size_t)level.width * 4;
+    for (int y = 0; y < level.height; y++)
+        memcpy(level.pixels.data() + (size_t)(level.height - 1 - y) * rowSize, bitmap.getLinePointer(y), rowSize);
+
+    texture->levels.push_back(std::move(level));
+    generateMipLevels(*texture);
+    return texture;
+}
+
+void MaterialLibrary::generateMipLevels(MaterialTexture& texture)
+{
+    if (texture.levels.empty())
+        return;
+
+    texture.levels.resize(1);
+    while (texture.levels.back().width > 1 || texture.levels.back().height > 1)
+    {
+        const auto& source = texture.levels.back();
+        MaterialTexture::Level level;
+        level.width = juce::jmax(1, source.width / 2);
+        level.height = juce::jmax(1, source.height / 2);
+        level.pixels.resize((size_t)level.width * (size_t)level.height * 4);
+
+        // Box filter over each 2x2 block, clamped at the edges of odd sized levels
+        for (int y = 0; y < level.height; y++)
+        {
+            int y0 = y * 2, y1 = juce::jmin(y0 + 1, source.height - 1);
+            for (int x = 0; x < level.width; x++)
+            {
+                int x0 = x * 2, x1 = juce::jmin(x0 + 1, source.width - 1);
+                const juce::uint8* p00 = source.pixels.data() + ((size_t)y0 * source.width + x0) * 4;
+                const juce::uint8* p01 = source.pixels.data() + ((size_t)y0 * source.width + x1) * 4;
+                const juce::uint8* p10 = source.pixels.data() + ((size_t)y1 * source.width + x0) * 4;
+                const juce::uint8* p11 = source.pixels.data() + ((size_t)y1 * source.width + x1) * 4;
+                juce::uint8* out = level.pixels.data() + ((size_t)y * level.width + x) * 4;
+                for (int c = 0; c < 4; c++)
+                    out[c] = (juce::uint8)((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+            }
+        }
+
+        texture.levels.push_back(std::move(level));
+    }
+}
+
+juce::File MaterialLibrary::getBakedFile(const juce::String& name) const
+{
+    return directory.getChildFile(juce::File::createLegalFileName(name) + bakedExtension);
+}
+
+std::shared_ptr<MaterialTexture> MaterialLibrary::readBaked(const juce::File& file, juce::uint64 sourceHash)
+{
+    if (!file.existsAsFile())
+        return nullptr;
+
+    juce::MemoryMappedFile mappedFile(file, juce::MemoryMappedFile::readOnly);
+    if (mappedFile.getData() == nullptr)
+        return nullptr;
+
+    // Header: magic, format version, source hash, number of levels
+    auto* data = static_cast<const char*>(mappedFile.getData());
+    size_t size = mappedFile.getSize();
+    const size_t headerSize = sizeof(bakedMagic) + sizeof(juce::uint32) + sizeof(juce::uint64) + sizeof(juce::uint32);
+    if (size < headerSize || memcmp(data, bakedMagic, sizeof(bakedMagic)) != 0)
+        return nullptr;
+
+    juce::uint32 formatVersion, numLevels;
+    juce::uint64 entryHash;
+    memcpy(&formatVersion, data + sizeof(bakedMagic), sizeof(formatVersion));
+    memcpy(&entryHash, data + sizeof(bakedMagic) + sizeof(formatVersion), sizeof(entryHash));
+    memcpy(&numLevels, data + sizeof(bakedMagic) + sizeof(formatVersion) + sizeof(entryHash), sizeof(numLevels));
+    if (formatVersion != bakedFormatVersion || entryHash != sourceHash || numLevels == 0 || numLevels > 32)
+        return nullptr;
+
+    // Each level: width, height, then its pixels
+    auto texture = std::make_shared<MaterialTexture>();
+    size_t offset = headerSize;
+    for (juce::uint32 i = 0; i < numLevels; i++)
+    {
+        MaterialTexture::Level level;
+        juce::int32 dimensions[2];
+        if (size - offset < sizeof(dimensions))
+            return nullptr;
+        memcpy(dimensions, data + offset, sizeof(dimensions));
+        offset += sizeof(dimensions);
+
+        if (dimensions[0] <= 0 || dimensions[1] <= 0 || dimensions[0] > 16384 || dimensions[1] > 16384)
+            return nullptr;
+
+        level.width = dimensions[0];
+        level.height = dimensions[1];
+        size_t levelSize = (size_t)level.width * (size_t)level.height * 4;
+        if (size - offset < levelSize)
+            return nullptr;
+
+        level.pixels.assign(data + offset, data + offset + levelSize);
+        offset += levelSize;
+        texture->levels.push_back(std::move(level));
+    }
+
+    return texture;
+}
+
+bool MaterialLibrary::writeBaked(const juce::File& file, juce::uint64 sourceHash, const MaterialTexture& texture)
+{
+    if (!directory.createDirectory())
+        return false;
+
+    juce::MemoryOutputStream stream;
+    juce::uint32 numLevels = (juce::uint32)texture.levels.size();
+    stream.write(bakedMagic, sizeof(bakedMagic));
+    stream.write(&bakedFormatVersion, sizeof(bakedFormatVersion));
+    stream.write(&sourceHash, sizeof(sourceHash));
+    stream.write(&numLevels, sizeof(numLevels));
+    for (auto& level : texture.levels)
+    {
+        juce::int32 dimensions[2] = { level.width, level.height };
+        stream.write(dimensions, sizeof(dimensions));
+        stream.write(level.pixels.data(), level.pixels.size());
+    }
+
+    // Write to a temporary file first, so another instance never reads half a file
+    juce::TemporaryFile temporaryFile(file);
+    return temporaryFile.getFile().replaceWithData(stream.getData(), stream.getDataSize())
+        && temporaryFile.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <JuceHeader.h>
+
+/***************************************************************/
+// A material's texture, decoded and ready to upload: the full
+// mip chain in juce::PixelARGB byte order, bottom row first as
+// OpenGL expects.
+/***************************************************************/
+struct MaterialTexture {
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<juce::uint8> pixels; // 4 bytes per pixel
+    };
+
+    juce::String name;
+    std::vector<Level> levels; // full size first, down to 1x1
+};
+
+/***************************************************************/
+// The material textures of every plugin instance in the process.
+//
+// Materials are decoded once, on a background thread, so opening
+// an editor doesn't wait for them and instances share one copy.
+// A decoded material is also baked to disk with its mip chain,
+// so later sessions load it without decoding the JPG again.
+/***************************************************************/
+class MaterialLibrary
+{
+public:
+    using Callback = std::function<void(std::shared_ptr<const MaterialTexture>)>;
+
+    MaterialLibrary();
+    explicit MaterialLibrary(const juce::File& bakedDirectory);
+    ~MaterialLibrary();
+
+    /** Returns the location of the baked materials shared by every instance of the plugin. */
+    static juce::File getDefaultDirectory();
+
+    /** Requests a material from its encoded image. The callback is called on the decoding thread once the material
+        is ready, or straight away if it already is. The data must stay valid until then (BinaryData always does). */
+    void request(const void* owner, const juce::String& name, const void* data, size_t size, Callback callback);
+
+    /** Drops the owner's requests, and waits for any of its callbacks that are running. */
+    void cancelRequests(const void* owner);
+
+    /** Decodes an encoded image and generates its mip chain, or returns nullptr if it can't be decoded. */
+    static std::shared_ptr<MaterialTexture> decode(const juce::String& name, const void* data, size_t size);
+
+    /** Fills in the mip chain below the first level, halving each side until 1x1. */
+    static void generateMipLevels(MaterialTexture& texture);
+
+private:
+    struct Request {
+        const void* owner = nullptr;
+        juce::String name;
+        const void* data = nullptr;
+        size_t size = 0;
+        Callback callback;
+    };
+
+    class Decoder : public juce::Thread
+    {
+    public:
+        explicit Decoder(MaterialLibrary& owner) : juce::Thread("MaterialLibrary"), library(owner) {}
+        void run() override;
+
+    private:
+        MaterialLibrary& library;
+    };
+
+    std::shared_ptr<const MaterialTexture> load(const Request& request);
+    std::shared_ptr<MaterialTexture> readBaked(const juce::File& file, juce::uint64 sourceHash);
+    bool writeBaked(const juce::File& file, juce::uint64 sourceHash, const MaterialTexture& texture);
+    juce::File getBakedFile(const juce::String& name) const;
+
+    juce::File directory;
+    std::mutex mutex;
+    std::condition_variable callbackFinished;
+    std::deque<Request> queue;
+    std::map<juce::String, std::shared_ptr<const MaterialTexture>> materials;
+    const void* runningOwner = nullptr; // owner of the callback being called, if any
+    Decoder decoder;
+};
@@ -25,15 +25,16 @@
 
 //==============================================================================
 RoomReverbPluginAudioProcessorEditor::RoomReverbPluginAudioProcessorEditor (RoomReverbPluginAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), roomRender (p.getSharedData(), p.getRayPaths())
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
     //Make room window visible
     buttonProcess.addListener(this);
+    buttonExport.addListener(this);
     addAndMakeVisible(roomRender);
     addAndMakeVisible(buttonProcess);
-    addAndMakeVisible(button2);
+    addAndMakeVisible(buttonExport);
     addAndMakeVisible(slider1);
     addAndMakeVisible(slider2);
     addAndMakeVisible(slider3);
@@ -42,6 +43,9 @@ RoomReverbPluginAudioProcessorEditor::RoomReverbPluginAudioProcessorEditor (Room
     //Set size of main window
     setSize(1000, 600);
 
+    // Poll the trace progress
+    startTimerHz(10);
+
     juce::Grid grid;
     using Track = juce::Grid::TrackInfo;
 
@@ -53,7 +57,7 @@ RoomReverbPluginAudioProcessorEditor::RoomReverbPluginAudioProcessorEditor (Room
                    juce::GridItem(roomRender).withArea(juce::GridItem::Span(5), juce::GridItem::Span(5)),
                    juce::GridItem(slider3).withArea(juce::GridItem::Span(1), juce::GridItem::Span(1)),
                    juce::GridItem(buttonProcess).withArea(juce::GridItem::Span(1), juce::GridItem::Span(1)),
-                   juce::GridItem(button2).withArea(juce::GridItem::Span(1), juce::GridItem::Span(1)) };
+                   juce::GridItem(buttonExport).withArea(juce::GridItem::Span(1), juce::GridItem::Span(1)) };
 
     grid.performLayout(getLocalBounds());
 }
@@ -61,8 +65,7 @@ RoomReverbPluginAudioProcessorEditor::RoomReverbPluginAudioProcessorEditor (Room
 RoomReverbPluginAudioProcessorEditor::~RoomReverbPluginAudioProcessorEditor()
 {
     buttonProcess.removeListener(this);
-
-    processReflections.stopThread(1000);
+    buttonExport.removeListener(this);
 }
 
 //==============================================================================
@@ -89,7 +92,100 @@ void RoomReverbPluginAudioProcessorEditor::buttonClicked(juce::Button* button)
     {
         DBG("Process button pressed!");
 
-        processReflections.startThread();
+        audioProcessor.startTrace (TraceJob::interactiveDeadline);
+    }
+    else if (button == &buttonExport)
+    {
+        showExportMenu();
+    }
+}
+
+void RoomReverbPluginAudioProcessorEditor::showExportMenu()
+{
+    using Format = IRExportSettings::Format;
+    using Layout = IRExportSettings::Layout;
+
+    const std::pair<Format, const char*> formats[] = { { Format::wavFloat, "WAV, 32-bit float" },
+                                                       { Format::wav24, "WAV, 24-bit" },
+                                                       { Format::flac, "FLAC, 24-bit" } };
+    const std::pair<Layout, const char*> layouts[] = { { Layout::mono, "Mono" },
+                                                       { Layout::stereo, "Stereo" },
+                                                       { Layout::binaural, "Binaural" },
+                                                       { Layout::ambisonic, "Ambisonic (first order AmbiX)" } };
+
+    juce::PopupMenu menu;
+    for (auto& format : formats)
+    {
+        juce::PopupMenu layoutMenu;
+        for (auto& layout : layouts)
+            layoutMenu.addItem(layout.second, [this, format, layout] { chooseExportFile(format.first, layout.first); });
+
+        menu.addSubMenu(format.second, layoutMenu);
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&buttonExport));
+}
+
+void RoomReverbPluginAudioProcessorEditor::chooseExportFile(IRExportSettings::Format format, IRExportSettings::Layout layout)
+{
+    juce::String extension = format == IRExportSettings::Format::flac ? ".flac" : ".wav";
+    juce::File defaultFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("Room IR" + extension);
+    exportChooser = std::make_unique<juce::FileChooser>("Export IR", defaultFile, "*" + extension);
 
+    int flags = juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles | juce::FileBrowserComponent::warnAboutOverwriting;
+    exportChooser->launchAsync(flags, [this, format, layout, extension](const juce::FileChooser& chooser)
+    {
+        juce::File file = chooser.getResult();
+        if (file == juce::File())
+            return;
+
+        IRExportSettings settings;
+        settings.file = file.withFileExtension(extension);
+        settings.format = format;
+        settings.layout = layout;
+        settings.sampleRate = audioProcessor.getSampleRate() > 0.0 ? audioProcessor.getSampleRate() : 48000.0;
+        settings.directionBuckets = audioProcessor.getSharedData().getSnapshot()->numberPolarBuckets;
+
+        // Exports finish in the background, possibly after the editor has closed
+        auto onFinished = [](const juce::File& exported, const juce::String& error)
+        {
+            if (error.isNotEmpty())
+                juce::MessageManager::callAsync([exported, error]
+                {
+                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Export IR",
+                                                           "Couldn't export " + exported.getFileName() + ": " + error);
+                });
+        };
+
+        if (!audioProcessor.exportImpulseResponses(settings, onFinished))
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Export IR", "Process the room before exporting its IR.");
+    });
+}
+
+void RoomReverbPluginAudioProcessorEditor::timerCallback()
+{
+    float progress = -1.0f;
+    double secondsRemaining;
+    juce::String text = "Process..";
+    if (audioProcessor.getTraceProgress(progress, secondsRemaining))
+    {
+        text = juce::String(juce::roundToInt(progress * 100.0f)) + "%";
+        if (secondsRemaining >= 0.0)
+            text << ", " << juce::roundToInt(secondsRemaining) << " s left";
+    }
+    else
+    {
+        progress = -1.0f;
+    }
+
+    if (buttonProcess.getButtonText() != text)
+        buttonProcess.setButtonText(text);
+
+    // The room view is only redrawn when the scene or the trace has moved on
+    if (progress != lastTraceProgress)
+    {
+        lastTraceProgress = progress;
+        roomRender.invalidate();
     }
+    roomRender.checkForSceneChanges();
 }
@@ -25,12 +25,11 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "RoomRender.h"
-#include "ProcessReflections.h"
 
 //==============================================================================
 /**
 */
-class RoomReverbPluginAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Button::Listener
+class RoomReverbPluginAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Button::Listener, private juce::Timer
 {
 public:
     RoomReverbPluginAudioProcessorEditor (RoomReverbPluginAudioProcessor&);
@@ -42,15 +41,20 @@ public:
     void buttonClicked(juce::Button* button) override;
 
 private:
+    void timerCallback() override;
+    void showExportMenu();
+    void chooseExportFile(IRExportSettings::Format format, IRExportSettings::Layout layout);
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     RoomReverbPluginAudioProcessor& audioProcessor;
 
     RoomRender roomRender;
-    ProcessReflections processReflections;
+    float lastTraceProgress = -1.0f; // -1 when no trace is running
 
     juce::TextButton buttonProcess{ "Process.." };
-    juce::TextButton button2{ "Button 2" };
+    juce::TextButton buttonExport{ "Export IR.." };
+    std::unique_ptr<juce::FileChooser> exportChooser;
     juce::Slider slider1{ juce::Slider::Rotary, juce::Slider::TextBoxBelow };
     juce::Slider slider2{ juce::Slider::Rotary, juce::Slider::TextBoxBelow };
     juce::Slider slider3{ juce::Slider::Rotary, juce::Slider::TextBoxBelow };
@@ -25,22 +25,48 @@
 #include <JucePluginDefines.h>
 
 //==============================================================================
+#ifndef JucePlugin_PreferredChannelConfigurations
+static juce::AudioProcessor::BusesProperties createBusesProperties()
+{
+    juce::AudioProcessor::BusesProperties properties;
+   #if ! JucePlugin_IsMidiEffect
+    #if ! JucePlugin_IsSynth
+    properties = properties.withInput ("Input", juce::AudioChannelSet::stereo(), true);
+
+    // The main input feeds the first sound source, further sources are optional sidechain-style inputs
+    for (int source = 1; source < RoomReverbPluginAudioProcessor::maxSoundSources; ++source)
+        properties = properties.withInput ("Source " + juce::String (source + 1), juce::AudioChannelSet::stereo(), false);
+    #endif
+    properties = properties.withOutput ("Output", juce::AudioChannelSet::stereo(), true);
+   #endif
+    return properties;
+}
+#endif
+
 RoomReverbPluginAudioProcessor::RoomReverbPluginAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
+     : AudioProcessor (createBusesProperties())
 #endif
 {
+    // Left alone, the listener parameters blend the grid at the scene's listener box
+    sceneListenerPosition = getListenerGridPosition (*sharedData.getSnapshot());
+    addParameter (listenerX = new juce::AudioParameterFloat ("listenerX", "Listener X", 0.0f, 1.0f, sceneListenerPosition.x));
+    addParameter (listenerY = new juce::AudioParameterFloat ("listenerY", "Listener Y", 0.0f, 1.0f, sceneListenerPosition.y));
+    addParameter (listenerZ = new juce::AudioParameterFloat ("listenerZ", "Listener Z", 0.0f, 1.0f, sceneListenerPosition.z));
+
+    // IRs are rendered and swapped in off the audio and message threads
+    impulseResponseLoader.startThread();
 }
 
 RoomReverbPluginAudioProcessor::~RoomReverbPluginAudioProcessor()
 {
+    impulseResponseLoader.signalThreadShouldExit();
+    impulseResponseLoader.notify();
+    impulseResponseLoader.stopThread (-1);
+
+    // Our jobs call back into this processor, so wait for them to stop
+    traceScheduler->cancelJobs (this);
+    traceScheduler->cancelJobs (&offlineResult);
 }
 
 //==============================================================================
@@ -78,7 +104,11 @@ bool RoomReverbPluginAudioProcessor::isMidiEffect() const
 
 double RoomReverbPluginAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    double tailLength = 0.0;
+    for (auto& convolver : convolvers)
+        tailLength = juce::jmax (tailLength, convolver.getDecayTime());
+
+    return tailLength;
 }
 
 int RoomReverbPluginAudioProcessor::getNumPrograms()
@@ -110,6 +140,79 @@ void RoomReverbPluginAudioProcessor::prepareToPlay (double sampleRate, int sampl
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = (juce::uint32) samplesPerBlock;
+    spec.numChannels = (juce::uint32) getTotalNumOutputChannels();
+
+    // Hosts switch to non-realtime and re-prepare for a bounce, where latency doesn't matter but quality does
+    renderingOffline = isNonRealtime();
+    auto profile = renderingOffline ? RoomConvolver::Profile::offline : RoomConvolver::Profile::realtime;
+    {
+        // The loader renders IRs at the rate the convolvers are prepared for, so change both at once
+        std::lock_guard<std::mutex> lock (impulseResponseLoadLock);
+        for (auto& convolver : convolvers)
+            convolver.prepare (spec, profile);
+
+        // Re-render the IR at the new sample rate
+        currentSampleRate = sampleRate;
+    }
+
+    setLatencySamples (convolvers[0].getLatency());
+
+    sourceBuffer.setSize (getTotalNumOutputChannels(), samplesPerBlock);
+    mixBuffer.setSize (getTotalNumOutputChannels(), samplesPerBlock);
+
+    if (renderingOffline)
+    {
+        // The bounce can't start before its IRs are loaded
+        if (auto result = traceOfflineImpulseResponse())
+        {
+            std::atomic_store (&offlineResult, result);
+            loadImpulseResponses (*result);
+        }
+    }
+    else
+    {
+        std::atomic_store (&offlineResult, std::shared_ptr<const TraceResult>());
+        requestImpulseResponseUpdate();
+    }
+}
+
+/***************************************************************/
+// Traces the scene at offline quality as a TraceScheduler job
+// that runs ahead of every realtime trace, and waits for it. It
+// only delays the start of a bounce, and is picked up from the
+// IRStore or IRCache if already traced. Returns nullptr if the
+// job was cancelled.
+//
+// The job is queued under its own owner key, so it doesn't
+// replace this instance's realtime trace.
+/***************************************************************/
+std::shared_ptr<const TraceResult> RoomReverbPluginAudioProcessor::traceOfflineImpulseResponse()
+{
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    std::shared_ptr<const TraceResult> result;
+    juce::WaitableEvent finished;
+    auto job = std::make_shared<TraceJob> (std::make_shared<const SharedData> (getOfflineQuality (*sharedData.getSnapshot())),
+                                           [&result, &finished] (std::shared_ptr<const TraceResult> traced)
+                                           {
+                                               result = std::move (traced);
+                                               finished.signal();
+                                           });
+    traceScheduler->submit (&offlineResult, job, TraceScheduler::offlineRender);
+
+    // A cancelled job never completes, so don't wait on it blindly
+    while (! finished.wait (50))
+        if (job->isCancelled())
+            break;
+
+    // The callback refers to this frame, so make sure the job is done with it
+    traceScheduler->cancelJobs (&offlineResult);
+
+    DBG ("Offline IR " << (result != nullptr ? "ready" : "cancelled") << " after " << juce::Time::getMillisecondCounterHiRes() - startTime << " ms");
+    return result;
 }
 
 void RoomReverbPluginAudioProcessor::releaseResources()
@@ -137,6 +240,16 @@ bool RoomReverbPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout&
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // Further sound sources can be mono, stereo or switched off
+    for (int bus = 1; bus < (int) layouts.inputBuses.size(); ++bus)
+    {
+        auto channelSet = layouts.getChannelSet (true, bus);
+        if (! channelSet.isDisabled()
+         && channelSet != juce::AudioChannelSet::mono()
+         && channelSet != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -159,17 +272,169 @@ void RoomReverbPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buf
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    // Each enabled input bus is a sound source: convolve it with its own IR
+    // and sum the results into the output
+    auto numSamples = buffer.getNumSamples();
+
+    // Moving the listener only needs a new blend of the precomputed grid IRs. A bounce blends
+    // here, before the block, so automation lands on the same sample every time it's rendered
+    if (listenerX->get() != lastListenerX || listenerY->get() != lastListenerY || listenerZ->get() != lastListenerZ)
+    {
+        lastListenerX = listenerX->get();
+        lastListenerY = listenerY->get();
+        lastListenerZ = listenerZ->get();
+
+        std::shared_ptr<const TraceResult> offline;
+        if (renderingOffline)
+            offline = std::atomic_load (&offlineResult);
+
+        if (offline != nullptr)
+            loadImpulseResponses (*offline);
+        else
+            requestImpulseResponseUpdate();
+    }
+
+    sourceBuffer.setSize (totalNumOutputChannels, numSamples, false, false, true);
+    mixBuffer.setSize (totalNumOutputChannels, numSamples, false, false, true);
+    mixBuffer.clear();
+
+    for (int source = 0; source < juce::jmin (getBusCount (true), maxSoundSources); ++source)
+    {
+        auto* bus = getBus (true, source);
+        if (bus == nullptr || ! bus->isEnabled() || bus->getNumberOfChannels() == 0)
+            continue;
+
+        auto input = getBusBuffer (buffer, true, source);
+        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
+            sourceBuffer.copyFrom (channel, 0, input, juce::jmin (channel, input.getNumChannels() - 1), 0, numSamples);
+
+        convolvers[(size_t) source].process (sourceBuffer);
+
+        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
+            mixBuffer.addFrom (channel, 0, sourceBuffer, channel, 0, numSamples);
+    }
+
+    for (int channel = 0; channel < totalNumOutputChannels; ++channel)
+        buffer.copyFrom (channel, 0, mixBuffer, channel, 0, numSamples);
+}
+
+//==============================================================================
+void RoomReverbPluginAudioProcessor::startTrace (double deadline)
+{
+    // Moving the listener box or resizing the room moves the listener parameters with it
+    auto listenerPosition = getListenerGridPosition (*sharedData.getSnapshot());
+    if (listenerPosition != sceneListenerPosition)
+    {
+        sceneListenerPosition = listenerPosition;
+        *listenerX = listenerPosition.x;
+        *listenerY = listenerPosition.y;
+        *listenerZ = listenerPosition.z;
+    }
+
+    auto onResult = [this] (std::shared_ptr<const TraceResult> result) { setTraceResult (result); };
+    currentTraceJob = std::make_shared<TraceJob> (sharedData.getSnapshot(), onResult, deadline, onResult);
+    currentTraceJob->rayPaths = &rayPaths;
+    currentTraceJob->traceLogFile = TraceLog::getFileFromEnvironment (ProcessReflections::hashScene (*currentTraceJob->scene));
+    traceScheduler->submit (this, currentTraceJob, tracePriority);
+}
+
+bool RoomReverbPluginAudioProcessor::getTraceProgress (float& progress, double& secondsRemaining) const
+{
+    if (currentTraceJob == nullptr || currentTraceJob->isCancelled() || currentTraceJob->getProgress() >= 1.0f)
+        return false;
+
+    progress = currentTraceJob->getProgress();
+    secondsRemaining = currentTraceJob->getSecondsRemaining();
+    return true;
+}
+
+void RoomReverbPluginAudioProcessor::setTraceResult (std::shared_ptr<const TraceResult> result)
+{
+    std::atomic_store (&traceResult, std::move (result));
+    requestImpulseResponseUpdate();
+}
+
+bool RoomReverbPluginAudioProcessor::exportImpulseResponses (const IRExportSettings& settings, IRExporter::Callback callback)
+{
+    auto result = std::atomic_load (&traceResult);
+    if (result == nullptr || result->sources.empty())
+        return false;
+
+    for (int source = 0; source < (int) result->sources.size(); ++source)
+    {
+        IRExportSettings sourceSettings = settings;
+        sourceSettings.file = settings.getSourceFile (source);
+
+        irExporter->exportIR (result, source, sourceSettings, callback);
+    }
+
+    return true;
+}
+
+void RoomReverbPluginAudioProcessor::requestImpulseResponseUpdate()
+{
+    // Only wakes the loader, so this is cheap enough for the audio thread
+    impulseResponseDirty = true;
+    impulseResponseLoader.notify();
+}
+
+void RoomReverbPluginAudioProcessor::ImpulseResponseLoader::run()
+{
+    while (! threadShouldExit())
+    {
+        wait (-1);
+
+        if (processor.impulseResponseDirty.exchange (false))
+            processor.updateImpulseResponse();
+    }
+}
+
+void RoomReverbPluginAudioProcessor::updateImpulseResponse()
+{
+    // A bounce loads its own IRs, in prepareToPlay and processBlock
+    if (renderingOffline && std::atomic_load (&offlineResult) != nullptr)
+        return;
+
+    activeResult = std::atomic_load (&traceResult);
+    if (activeResult != nullptr)
+        loadImpulseResponses (*activeResult);
+}
+
+/***************************************************************/
+// Renders the IR of each sound source of the result and loads
+// it into that source's convolver. Touches no message thread
+// state, so prepareToPlay and the audio thread of a bounce can
+// load an offline result with it.
+/***************************************************************/
+void RoomReverbPluginAudioProcessor::loadImpulseResponses (const TraceResult& result)
+{
+    std::lock_guard<std::mutex> lock (impulseResponseLoadLock);
+    double sampleRate = currentSampleRate;
+    if (sampleRate <= 0.0)
+        return;
+
+    int numChannels = juce::jmax (1, getTotalNumOutputChannels());
+    Vector3<float> listener (listenerX->get(), listenerY->get(), listenerZ->get());
+
+    for (int source = 0; source < juce::jmin ((int) result.sources.size(), maxSoundSources); ++source)
     {
-        auto* channelData = buffer.getWritePointer (channel);
+        auto& sourceResult = result.sources[(size_t) source];
+        juce::AudioBuffer<float> ir;
+
+        if (sourceResult.receiverGrid != nullptr)
+        {
+            auto blend = sourceResult.receiverGrid->getBlend (listener);
+            sourceResult.receiverGrid->renderBlend (blend, ir, sampleRate, numChannels);
+        }
+        else if (! sourceResult.listenerIR.empty())
+        {
+            ir.setSize (numChannels, getImpulseResponseLength (sourceResult.listenerIR, sampleRate));
+            ir.clear();
+            renderImpulseResponse (sourceResult.listenerIR, ir, sampleRate);
+        }
 
-        // ..do something to the data...
+        if (ir.getNumSamples() > 0)
+            convolvers[(size_t) source].loadImpulseResponse (std::move (ir), sampleRate);
     }
 }
 
@@ -181,21 +446,197 @@ bool RoomReverbPluginAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* RoomReverbPluginAudioProcessor::createEditor()
 {
+    // Instances the user is looking at get their traces first
+    tracePriority = TraceScheduler::visibleEditor;
+    traceScheduler->setPriority (this, tracePriority);
+
     return new RoomReverbPluginAudioProcessorEditor (*this);
 }
 
+void RoomReverbPluginAudioProcessor::editorBeingDeleted (juce::AudioProcessorEditor* editor) noexcept
+{
+    tracePriority = TraceScheduler::background;
+    traceScheduler->setPriority (this, tracePriority);
+
+    AudioProcessor::editorBeingDeleted (editor);
+}
+
 //==============================================================================
+// Plugin state: a small uncompressed header (magic, format version, flags)
+// followed by a gzipped payload of the parameters, the scene and,
+// optionally, the scene hash and sparse taps of the last trace.
+static const char stateMagic[4] = { 'R', 'R', 'S', 'T' };
+static const int stateFormatVersion = 1;
+static const int stateHasImpulseResponse = 1;
+
+static void writeVector (juce::OutputStream& stream, Vector3<float> v)
+{
+    stream.writeFloat (v.x);
+    stream.writeFloat (v.y);
+    stream.writeFloat (v.z);
+}
+
+static Vector3<float> readVector (juce::InputStream& stream)
+{
+    float x = stream.readFloat();
+    float y = stream.readFloat();
+    float z = stream.readFloat();
+    return { x, y, z };
+}
+
+static void writeScene (juce::OutputStream& stream, const SharedData& scene)
+{
+    writeVector (stream, scene.roomSize);
+    writeVector (stream, scene.roomPos);
+    writeVector (stream, scene.listenerPos);
+    writeVector (stream, scene.listenerSize);
+    stream.writeInt ((int) scene.soundSourcePositions.size());
+    for (auto& position : scene.soundSourcePositions)
+        writeVector (stream, position);
+
+    stream.writeFloat (scene.speedOfSound);
+    stream.writeFloat (scene.rollOff);
+    stream.writeFloat (scene.delayBucketSize);
+    stream.writeFloat (scene.refinementTolerance);
+    stream.writeInt (scene.additionalRays);
+    stream.writeInt (scene.numberPolarBuckets);
+    stream.writeInt (scene.maxRefinementRounds);
+    stream.writeInt (scene.receiverGridX);
+    stream.writeInt (scene.receiverGridY);
+    stream.writeInt (scene.receiverGridZ);
+}
+
+static bool readScene (juce::InputStream& stream, SharedData& scene)
+{
+    // Four vectors and the source count, then the sources and ten settings
+    if (stream.getNumBytesRemaining() < 4 * 12 + 4)
+        return false;
+
+    scene.roomSize = readVector (stream);
+    scene.roomPos = readVector (stream);
+    scene.listenerPos = readVector (stream);
+    scene.listenerSize = readVector (stream);
+
+    int numSources = stream.readInt();
+    if (numSources < 0 || numSources > RoomReverbPluginAudioProcessor::maxSoundSources
+        || stream.getNumBytesRemaining() < numSources * 12 + 10 * 4)
+        return false;
+
+    scene.soundSourcePositions.clear();
+    for (int source = 0; source < numSources; ++source)
+        scene.soundSourcePositions.push_back (readVector (stream));
+
+    // The next trace allocates whatever these say, so keep them to the ranges a batch manifest allows
+    using Limits = SharedData::Limits;
+    scene.speedOfSound = juce::jmax (1.0f, stream.readFloat());
+    scene.rollOff = juce::jmax (0.0f, stream.readFloat());
+    scene.delayBucketSize = juce::jmax (1e-4f, stream.readFloat());
+    scene.refinementTolerance = juce::jmax (0.0f, stream.readFloat());
+    scene.additionalRays = juce::jlimit (0, Limits::additionalRays, stream.readInt());
+    scene.numberPolarBuckets = juce::jlimit (1, Limits::numberPolarBuckets, stream.readInt());
+    scene.maxRefinementRounds = juce::jlimit (0, Limits::maxRefinementRounds, stream.readInt());
+    scene.receiverGridX = juce::jlimit (0, Limits::receiverGridSize, stream.readInt());
+    scene.receiverGridY = juce::jlimit (0, Limits::receiverGridSize, stream.readInt());
+    scene.receiverGridZ = juce::jlimit (0, Limits::receiverGridSize, stream.readInt());
+    return true;
+}
+
 void RoomReverbPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    auto result = std::atomic_load (&traceResult);
+    bool includeImpulseResponse = includeImpulseResponseInState && result != nullptr && result->complete;
+
+    juce::MemoryOutputStream output (destData, false);
+    output.write (stateMagic, sizeof (stateMagic));
+    output.writeInt (stateFormatVersion);
+    output.writeInt (includeImpulseResponse ? stateHasImpulseResponse : 0);
+
+    juce::GZIPCompressorOutputStream payload (output);
+    payload.writeFloat (listenerX->get());
+    payload.writeFloat (listenerY->get());
+    payload.writeFloat (listenerZ->get());
+    writeScene (payload, *sharedData.getSnapshot());
+
+    if (includeImpulseResponse)
+    {
+        payload.writeInt64 ((juce::int64) result->sceneHash);
+        writeTraceResult (payload, *result);
+    }
+
+    payload.flush();
 }
 
 void RoomReverbPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    // Hosts may call this on every undo step, so keep an eye on what it costs
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    juce::MemoryInputStream input (data, (size_t) sizeInBytes, false);
+    char magic[4];
+    if (input.read (magic, sizeof (magic)) != sizeof (magic) || memcmp (magic, stateMagic, sizeof (magic)) != 0)
+        return;
+
+    // Only one format has shipped, anything else was written by a newer version of the plugin
+    int formatVersion = input.readInt();
+    int flags = input.readInt();
+    if (formatVersion != stateFormatVersion)
+        return;
+
+    juce::MemoryBlock payloadData;
+    juce::GZIPDecompressorInputStream decompressor (input);
+    decompressor.readIntoMemoryBlock (payloadData);
+    juce::MemoryInputStream payload (payloadData, false);
+
+    if (payload.getNumBytesRemaining() < 3 * 4)
+        return;
+
+    float x = payload.readFloat();
+    float y = payload.readFloat();
+    float z = payload.readFloat();
+
+    SharedData scene (*sharedData.getSnapshot());
+    if (! readScene (payload, scene))
+        return;
+
+    *listenerX = x;
+    *listenerY = y;
+    *listenerZ = z;
+    sceneListenerPosition = getListenerGridPosition (scene);
+    requestImpulseResponseUpdate();
+    sharedData.update ([&scene] (SharedData& current)
+    {
+        auto version = current.version;
+        current = scene;
+        current.version = version;
+    });
+
+    if ((flags & stateHasImpulseResponse) != 0)
+    {
+        auto sceneHash = (juce::uint64) payload.readInt64();
+        auto current = std::atomic_load (&traceResult);
+
+        // Undo often restores the IR that is already loaded, and sessions often hold many instances
+        // on the same room, so only decode an IR that no instance has in memory. An intermediate
+        // result of the same scene still in flight doesn't count, the saved IR is the finished one
+        if (current == nullptr || current->sceneHash != sceneHash || ! current->complete)
+        {
+            if (auto shared = irStore->find (sceneHash))
+            {
+                setTraceResult (shared);
+            }
+            else
+            {
+                auto position = (size_t) payload.getPosition();
+                if (auto result = readTraceResult (static_cast<const char*> (payloadData.getData()) + position, payloadData.getSize() - position))
+                {
+                    result->sceneHash = sceneHash;
+                    setTraceResult (irStore->add (std::move (result)));
+                }
+            }
+        }
+    }
+
+    DBG ("Restored plugin state (" << sizeInBytes << " bytes) in " << juce::Time::getMillisecondCounterHiRes() - startTime << " ms");
 }
 
 //==============================================================================
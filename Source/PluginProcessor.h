@@ -23,7 +23,7 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "SharedData.h"
+#include "TraceScheduler.h"
 
 //==============================================================================
 /**
@@ -48,6 +48,7 @@ public:
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
+    void editorBeingDeleted (juce::AudioProcessorEditor*) noexcept override;
 
     //==============================================================================
     const juce::String getName() const override;
@@ -68,10 +69,80 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-    std::shared_ptr<SharedData> getSharedData() { return sharedData; }
+    /** The scene of this instance, shared with its editor and tracer. */
+    SharedDataState& getSharedData() { return sharedData; }
+
+    /** A sample of the paths traced for this instance, for the editor to draw. */
+    RayPathRing& getRayPaths() { return rayPaths; }
+
+    /** Each sound source in the room has its own input bus, convolved with that source's IR. */
+    static constexpr int maxSoundSources = 8;
+
+    /** Queues a trace of the current scene, replacing any trace of an older scene.
+        With a deadline (in seconds), a first IR is heard by then and refined until the trace completes.
+    */
+    void startTrace (double deadline = 0.0);
+
+    /** Returns true while a trace is queued or running, with its progress (0..1) and estimated seconds left (negative if unknown). */
+    bool getTraceProgress (float& progress, double& secondsRemaining) const;
+
+    /** Hands over the result of a trace. Safe to call from any thread. */
+    void setTraceResult (std::shared_ptr<const TraceResult> result);
+
+    /** Queues a background export of the listener IR of every sound source of the latest result.
+        Each source is written to its file, see IRExportSettings::getSourceFile().
+        Returns false if nothing has been traced yet.
+    */
+    bool exportImpulseResponses (const IRExportSettings& settings, IRExporter::Callback callback = nullptr);
+
+    /** Whether the plugin state carries the traced IRs, so sessions reopen without retracing. */
+    void setIncludeImpulseResponseInState (bool shouldInclude) { includeImpulseResponseInState = shouldInclude; }
 
 private:
-    std::shared_ptr<SharedData> sharedData;
+    // Renders and loads new IRs whenever the audio thread, a trace or a state change asks for them
+    class ImpulseResponseLoader : public juce::Thread
+    {
+    public:
+        explicit ImpulseResponseLoader (RoomReverbPluginAudioProcessor& owner) : juce::Thread ("ImpulseResponseLoader"), processor (owner) {}
+        void run() override;
+
+    private:
+        RoomReverbPluginAudioProcessor& processor;
+    };
+
+    void requestImpulseResponseUpdate();
+    void updateImpulseResponse();
+    void loadImpulseResponses (const TraceResult& result);
+    std::shared_ptr<const TraceResult> traceOfflineImpulseResponse();
+
+    SharedDataState sharedData;
+    RayPathRing rayPaths;
+    juce::SharedResourcePointer<TraceScheduler> traceScheduler;
+    juce::SharedResourcePointer<IRStore> irStore;
+    juce::SharedResourcePointer<IRExporter> irExporter;
+    std::shared_ptr<TraceJob> currentTraceJob; // message thread only
+    int tracePriority = TraceScheduler::background;
+
+    // Listener position within the receiver grid, normalised to 0..1 on each axis
+    juce::AudioParameterFloat* listenerX;
+    juce::AudioParameterFloat* listenerY;
+    juce::AudioParameterFloat* listenerZ;
+    float lastListenerX = -1.0f, lastListenerY = -1.0f, lastListenerZ = -1.0f;
+
+    // The scene's listener box in the same coordinates, the parameters follow it when it moves (message thread only)
+    Vector3<float> sceneListenerPosition;
+
+    std::array<RoomConvolver, maxSoundSources> convolvers;
+    juce::AudioBuffer<float> sourceBuffer, mixBuffer;
+    std::atomic<double> currentSampleRate { 0.0 };
+    std::shared_ptr<const TraceResult> traceResult;   // Published by the trace thread
+    std::shared_ptr<const TraceResult> activeResult;  // Owned by the loader thread
+    std::shared_ptr<const TraceResult> offlineResult; // Used instead of traceResult while rendering offline, published by prepareToPlay
+    std::atomic<bool> renderingOffline { false };
+    std::mutex impulseResponseLoadLock; // prepareToPlay, a bounce's audio thread and the loader may all prepare or load IRs into the convolvers
+    std::atomic<bool> impulseResponseDirty { false };
+    std::atomic<bool> includeImpulseResponseInState { true };
+    ImpulseResponseLoader impulseResponseLoader { *this };
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RoomReverbPluginAudioProcessor)
 };
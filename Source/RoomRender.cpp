@@ -17,7 +17,7 @@
 #include "ExMatrix3D.h"
 
 //==============================================================================
-RoomRender::RoomRender()
+RoomRender::RoomRender(SharedDataState& state, RayPathRing& paths) : sharedData(state), rayPaths(paths)
 {
     // In your constructor, you should add any child components, and
     // initialise any special settings that your component needs.
@@ -27,11 +27,40 @@ RoomRender::RoomRender()
 
     myMouseListener = std::make_unique<MyMouseListener>();
     myMouseListener->setMyClassInstance(&camera);
+    myMouseListener->onCameraMoved = [this] { invalidate(); };
     addMouseListener(myMouseListener.get(), true);
+
+    // The tracer only samples its paths while a view is open
+    newSegments.resize(MAX_SEGMENTS_PER_FRAME);
+    rayPaths.setEnabled(true);
+
+    // Frames are only rendered on request, see invalidate()
+    openGLContext.setContinuousRepainting(false);
+    sceneVersion = sharedData.getSnapshot()->version;
+
+    // Materials are decoded in the background; each slot is drawn once its texture arrives
+    struct MaterialResource { const char* data; int size; const char* name; };
+    static const MaterialResource materials[] = {
+        { BinaryData::Bricks060_1KJPG_Color_jpg, BinaryData::Bricks060_1KJPG_Color_jpgSize, "Bricks060_1K-JPG_Color.jpg" },
+        { BinaryData::Wood090A_1KJPG_Color_jpg, BinaryData::Wood090A_1KJPG_Color_jpgSize, "Wood090A_1K-JPG_Color.jpg" },
+        { BinaryData::Tiles136A_1KJPG_Color_jpg, BinaryData::Tiles136A_1KJPG_Color_jpgSize, "Tiles136A_1K-JPG_Color.jpg" } };
+
+    for (int slot = 0; slot < juce::numElementsInArray(materials); slot++)
+    {
+        materialLibrary->request(this, materials[slot].name, materials[slot].data, (size_t)materials[slot].size,
+            [this, slot](std::shared_ptr<const MaterialTexture> texture)
+            {
+                // Only uploaded to the GPU if the material has changed
+                textureResidency.setTexture(slot, texture->name, texture);
+                invalidate();
+            });
+    }
 }
 
 RoomRender::~RoomRender()
 {
+    rayPaths.setEnabled(false);
+    materialLibrary->cancelRequests(this);
     shutdownOpenGL();
 }
 
@@ -39,21 +68,15 @@ void RoomRender::initialise()
 {
     // Initialize OpenGL resources here
     createShaders();
+    createLineShader();
 
-    auto& sharedData = SharedDataSingleton::getInstance();
-    std::lock_guard<std::mutex> lock(sharedData.vectorMutex);
-    roomSize = juce::Vector3D<float>(20.0f, 20.0f, 20.0f);
-    sharedData.roomSize = roomSize;
-    sharedData.soundSourcePos = juce::Vector3D<float>(9.0f, 9.0f, 9.0f);
+    // The scene belongs to the processor; the view starts from its current snapshot
+    auto snapshot = sharedData.getSnapshot();
+    roomSize = toVector3D(snapshot->roomSize);
 
     //shape->roomSize = roomSize;
-    cameraPos = Vector3D<float>(2.0f, 2.0f, 2.0f);
-    sharedData.listenerPos = cameraPos;
-
-    // Make the listener box scale with the room to help manage the processing overhead
-    sharedData.listenerSize = roomSize / 20.0f;
-    roomPos = roomSize / 2;
-    sharedData.roomPos = roomPos;
+    cameraPos = toVector3D(snapshot->listenerPos);
+    roomPos = toVector3D(snapshot->roomPos);
 
     camera = Camera(cameraPos, Vector3D<float>(0.0f, 1.0f, 0.0f), 0.0f);
 
@@ -61,23 +84,33 @@ void RoomRender::initialise()
     camera.lastY = height / 2;
 
     // Add shapes
-    shape->addShapes(sharedData.walls, sharedData.floor, sharedData.ceiling, roomSize);
+    shape->addShapes(snapshot->geometry);
+
+    invalidate();
 }
 
 void RoomRender::shutdown()
 {
     // Clean up OpenGL resources here
     shader.reset();
-    shape->texture1.release();
-    shape->texture2.release();
-    shape->texture3.release();
+    textureResidency.releaseAll();
     shape.reset();
     attributes.reset();
     uniforms.reset();
+
+    using namespace ::juce::gl;
+    if (lineBuffer != 0)
+        glDeleteBuffers(1, &lineBuffer);
+    lineBuffer = 0;
+    lineShader.reset();
+    lineAttributes.reset();
+    lineUniforms.reset();
 }
 
 void RoomRender::render()
 {
+    frameScheduler.beginFrame();
+
     // Your OpenGL rendering code here
     // This clears the context with a black background.
     juce::OpenGLHelpers::clear(juce::Colours::black);
@@ -90,12 +123,15 @@ void RoomRender::render()
     auto desktopScale = (float)openGLContext.getRenderingScale();
     juce::OpenGLHelpers::clear(juce::OpenGLAppComponent::getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
 
-    if (shape->textures[0] != nullptr)
-        shape->textures[0]->applyTo(shape->texture1);
-    if (shape->textures[1] != nullptr)
-        shape->textures[1]->applyTo(shape->texture2);
-    if (shape->textures[2] != nullptr)
-        shape->textures[2]->applyTo(shape->texture3);
+    // Textures are only uploaded when their material changes, not every frame
+    textureResidency.update();
+
+    // The room may have been moved or resized since the last frame, in which case its buffers are rebuilt
+    auto snapshot = sharedData.getSnapshot();
+    if (snapshot->geometry != shape->geometry)
+        shape->addShapes(snapshot->geometry);
+    roomSize = toVector3D(shape->geometry->roomSize);
+    roomPos = toVector3D(shape->geometry->roomPos);
 
     glEnable(GL_DEPTH_TEST);
 
@@ -106,9 +142,6 @@ void RoomRender::render()
         juce::roundToInt(desktopScale * width),
         juce::roundToInt(desktopScale * height));
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
     shader->use();
 
     Matrix3D<float> projection;
@@ -134,10 +167,78 @@ void RoomRender::render()
     if (uniforms->texture3 != nullptr)
         uniforms->texture3->set((GLint)2);
 
-    shape->draw(*attributes);
+    shape->draw(*attributes, textureResidency);
+
+    drawRayPaths(projection, view);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    frameScheduler.endFrame();
+}
+
+void RoomRender::drawRayPaths(const Matrix3D<float>& projection, const Matrix3D<float>& view)
+{
+    using namespace ::juce::gl;
+
+    // Only a frame's worth of new segments is added; if more are waiting, another frame is requested
+    int numNewSegments = rayPaths.pop(newSegments.data(), MAX_SEGMENTS_PER_FRAME);
+    rayLines.add(newSegments.data(), numNewSegments);
+    if (rayPaths.getNumReady() > 0)
+        invalidate();
+
+    if (lineShader == nullptr || rayLines.getNumVertices() == 0)
+        return;
+
+    if (lineBuffer == 0)
+    {
+        glGenBuffers(1, &lineBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, lineBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr> ((size_t)rayLines.getCapacity() * sizeof(RayPathLines::Vertex)),
+            nullptr, GL_DYNAMIC_DRAW);
+        rayLines.markAllChanged();
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, lineBuffer);
+    }
+
+    // Only the vertices written since the last frame are uploaded
+    auto changed = rayLines.takeChangedRange();
+    if (!changed.isEmpty())
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr> ((size_t)changed.getStart() * sizeof(RayPathLines::Vertex)),
+            static_cast<GLsizeiptr> ((size_t)changed.getLength() * sizeof(RayPathLines::Vertex)),
+            rayLines.getVertices() + changed.getStart());
+
+    lineShader->use();
+    if (lineUniforms->projection.get() != nullptr)
+        lineUniforms->projection->setMatrix4(projection.mat, 1, false);
+    if (lineUniforms->view.get() != nullptr)
+        lineUniforms->view->setMatrix4(view.mat, 1, false);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    lineAttributes->enable();
+    glDrawArrays(GL_LINES, 0, rayLines.getNumVertices());
+    lineAttributes->disable();
+    glDisable(GL_BLEND);
+}
+
+void RoomRender::invalidate()
+{
+    // Repaint requests made while a frame is already pending are folded into it
+    if (frameScheduler.invalidate())
+        openGLContext.triggerRepaint();
+}
+
+void RoomRender::checkForSceneChanges()
+{
+    auto version = sharedData.getSnapshot()->version;
+    if (version != sceneVersion)
+    {
+        sceneVersion = version;
+        invalidate();
+    }
 }
 
 
@@ -229,6 +330,50 @@ void RoomRender::createShaders()
     }
 }
 
+void RoomRender::createLineShader()
+{
+    juce::String lineVertexShader = R"(
+        attribute vec3 position;
+        attribute vec4 colour;
+
+        uniform mat4 view;
+        uniform mat4 projection;
+
+        varying vec4 colourOut;
+
+        void main()
+        {
+            // Ray paths are already in world space
+            gl_Position = projection * view * vec4(position, 1.0f);
+            colourOut = colour;
+        }
+        )";
+
+    juce::String lineFragmentShader = R"(
+        varying vec4 colourOut;
+
+        void main()
+        {
+            gl_FragColor = colourOut;
+        }
+        )";
+
+    std::unique_ptr<juce::OpenGLShaderProgram> newShader(new juce::OpenGLShaderProgram(openGLContext));
+
+    if (newShader->addVertexShader(juce::OpenGLHelpers::translateVertexShaderToV3(lineVertexShader))
+        && newShader->addFragmentShader(juce::OpenGLHelpers::translateFragmentShaderToV3(lineFragmentShader))
+        && newShader->link())
+    {
+        lineShader.reset(newShader.release());
+        lineAttributes.reset(new LineAttributes(*lineShader));
+        lineUniforms.reset(new Uniforms(*lineShader));
+    }
+    else
+    {
+        DBG(newShader->getLastError());
+    }
+}
+
 bool RoomRender::keyPressed(const juce::KeyPress& key, juce::Component* originatingComponent)
 {
     if (key == juce::KeyPress::escapeKey)
@@ -236,5 +381,17 @@ bool RoomRender::keyPressed(const juce::KeyPress& key, juce::Component* originat
         juce::JUCEApplication::getInstance()->systemRequestedQuit();
         return true;
     }
+
+    // WASD moves the camera
+    static const std::pair<int, Camera_Movement> movementKeys[] = { { 'W', FORWARD }, { 'S', BACKWARD }, { 'A', LEFT }, { 'D', RIGHT } };
+    for (auto& movementKey : movementKeys)
+    {
+        if (juce::CharacterFunctions::toUpperCase(key.getTextCharacter()) == movementKey.first)
+        {
+            camera.ProcessKeyboard(movementKey.second, KEY_MOVEMENT_TIME);
+            invalidate();
+            return true;
+        }
+    }
     return false;
 }
@@ -14,9 +14,12 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <JuceHeader.h>
 #include "Camera.h"
-#include "SharedData.h"
+#include "FrameScheduler.h"
+#include "TextureResidency.h"
 
 class MyMouseListener : public juce::MouseListener
 {
@@ -33,11 +36,16 @@ public:
         cameraClassInstance->updateMousePosition(mousePos);
 
         //DBG(mousePos.x);
+        if (onCameraMoved != nullptr)
+            onCameraMoved();
     }
 
     void mouseWheelMove(const juce::MouseEvent& event)
     {
         cameraClassInstance->ProcessMouseScroll(event.getPosition().y);
+
+        if (onCameraMoved != nullptr)
+            onCameraMoved();
     }
 
     void setMyClassInstance(Camera* instance)
@@ -45,6 +53,8 @@ public:
         cameraClassInstance = instance;
     }
 
+    std::function<void()> onCameraMoved; // called on the message thread after the camera has changed
+
 private:
     Camera* cameraClassInstance = nullptr;
 };
@@ -54,7 +64,7 @@ private:
 class RoomRender  : public juce::OpenGLAppComponent, public juce::KeyListener
 {
 public:
-    RoomRender();
+    RoomRender(SharedDataState& state, RayPathRing& paths);
     ~RoomRender() override;
 
     void initialise() override;
@@ -65,18 +75,22 @@ public:
     void resized() override;
 
     void createShaders();
+    void createLineShader();
     bool keyPressed(const juce::KeyPress& key, juce::Component* originatingComponent) override;
 
+    /** Requests a new frame. The view is only rendered when something has changed, so call this after anything that alters it. */
+    void invalidate();
+
+    /** Requests a new frame if the scene has changed since the last check. Call on the message thread. */
+    void checkForSceneChanges();
+
+    const FrameScheduler& getFrameScheduler() const { return frameScheduler; }
+
 private:
     //==============================================================================
     // Your private member variables go here...
 
-    struct Vertex
-    {
-        float position[3];
-        float texCoord[2];
-        float type;
-    };
+    using Vertex = SceneGeometry::Vertex;
 
     struct Attributes
     {
@@ -133,6 +147,43 @@ private:
         }
     };
 
+    // The attributes of the ray path shader, see RayPathLines::Vertex
+    struct LineAttributes
+    {
+        explicit LineAttributes(juce::OpenGLShaderProgram& shaderProgram)
+        {
+            position.reset(Attributes::createAttribute(shaderProgram, "position"));
+            colour.reset(Attributes::createAttribute(shaderProgram, "colour"));
+        }
+
+        void enable()
+        {
+            using namespace ::juce::gl;
+
+            if (position.get() != nullptr)
+            {
+                glVertexAttribPointer(position->attributeID, 3, GL_FLOAT, GL_FALSE, sizeof(RayPathLines::Vertex), nullptr);
+                glEnableVertexAttribArray(position->attributeID);
+            }
+
+            if (colour.get() != nullptr)
+            {
+                glVertexAttribPointer(colour->attributeID, 4, GL_FLOAT, GL_FALSE, sizeof(RayPathLines::Vertex), (GLvoid*)(sizeof(float) * 3));
+                glEnableVertexAttribArray(colour->attributeID);
+            }
+        }
+
+        void disable()
+        {
+            using namespace ::juce::gl;
+
+            if (position.get() != nullptr) glDisableVertexAttribArray(position->attributeID);
+            if (colour.get() != nullptr) glDisableVertexAttribArray(colour->attributeID);
+        }
+
+        std::unique_ptr<juce::OpenGLShaderProgram::Attribute> position, colour;
+    };
+
     struct Uniforms
     {
         explicit Uniforms(juce::OpenGLShaderProgram& shaderProgram)
@@ -159,216 +210,112 @@ private:
         }
     };
 
+    // The room, drawn in a single call from the SceneGeometry of the scene snapshot
     struct Shape
     {
-        Shape()
-        {
-        }
-        
-        void addShapes(std::vector<float> verticesWalls, std::vector<float> verticesFloor, std::vector<float> verticesCeiling, Vector3D<float> roomSize)
+        void addShapes(std::shared_ptr<const SceneGeometry> sceneGeometry)
         {
-            // Modify the texture coordinates to accommodate size of room
-            verticesWalls.at(9) *= roomSize.x;
-            verticesWalls.at(15) *= roomSize.x;
-            verticesWalls.at(16) *= roomSize.y;
-            verticesWalls.at(22) *= roomSize.y;
-            verticesWalls.at(9 + 24) *= roomSize.x;
-            verticesWalls.at(15 + 24) *= roomSize.x;
-            verticesWalls.at(16 + 24) *= roomSize.y;
-            verticesWalls.at(22 + 24) *= roomSize.y;
-            verticesWalls.at(9 + 48) *= roomSize.z;
-            verticesWalls.at(15 + 48) *= roomSize.z;
-            verticesWalls.at(16 + 48) *= roomSize.y;
-            verticesWalls.at(22 + 48) *= roomSize.y;
-            verticesWalls.at(9 + 72) *= roomSize.z;
-            verticesWalls.at(15 + 72) *= roomSize.z;
-            verticesWalls.at(16 + 72) *= roomSize.y;
-            verticesWalls.at(22 + 72) *= roomSize.y;
-            verticesFloor.at(9) *= roomSize.x;
-            verticesFloor.at(15) *= roomSize.x;
-            verticesFloor.at(16) *= roomSize.z;
-            verticesFloor.at(22) *= roomSize.z;
-            verticesCeiling.at(9) *= roomSize.x;
-            verticesCeiling.at(15) *= roomSize.x;
-            verticesCeiling.at(16) *= roomSize.z;
-            verticesCeiling.at(22) *= roomSize.z;
-
-            // Add shapes to vertex buffer and remove old vertices if there are any
-            if (vertexBuffers.size() != 0)
-            {
-                vertexBuffers.clear(true);
-            }
-            vertexBuffers.add(new VertexBuffer(verticesWalls, verticesWalls.size()/4));
-            vertexBuffers.add(new VertexBuffer(verticesFloor, verticesFloor.size()/4));
-            vertexBuffers.add(new VertexBuffer(verticesCeiling, verticesCeiling.size()/4));
-            // Add texture(s) and remove old ones if there are any
-            if (textures.size() != 0)
-            {
-                textures.clear(true);
-            }
-            
-            // Import textures from binary data
-            textures.add(new TextureFromBinary(BinaryData::Bricks060_1KJPG_Color_jpg,
-                (size_t)BinaryData::Bricks060_1KJPG_Color_jpgSize,
-                "Bricks060_1K-JPG_Color.jpg"));
-            textures.add(new TextureFromBinary(BinaryData::Wood090A_1KJPG_Color_jpg,
-                (size_t)BinaryData::Wood090A_1KJPG_Color_jpgSize,
-                "Wood090A_1K-JPG_Color.jpg"));
-            textures.add(new TextureFromBinary(BinaryData::Tiles136A_1KJPG_Color_jpg,
-                (size_t)BinaryData::Tiles136A_1KJPG_Color_jpgSize,
-                "Tiles136A_1K-JPG_Color.jpg"));
+            using namespace ::juce::gl;
+
+            geometry = std::move(sceneGeometry);
+            deleteBuffers();
 
+            glGenBuffers(1, &vertexBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+            glBufferData(GL_ARRAY_BUFFER,
+                static_cast<GLsizeiptr> (geometry->vertices.size() * sizeof(Vertex)),
+                geometry->vertices.data(), GL_STATIC_DRAW);
+
+            glGenBuffers(1, &indexBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                static_cast<GLsizeiptr> (geometry->indices.size() * sizeof(juce::uint32)),
+                geometry->indices.data(), GL_STATIC_DRAW);
         }
 
-        void modifyShapes(Vector3D<float> size)
+        ~Shape()
         {
-
+            deleteBuffers();
         }
 
-        void draw(Attributes& glAttributes)
+        void draw(Attributes& glAttributes, TextureResidency& residency)
         {
             using namespace ::juce::gl;
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            if (geometry == nullptr)
+                return;
 
-            vertexBuffers[0]->bind();
+            glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
             glAttributes.enable();
-            glActiveTexture(GL_TEXTURE0);
-            texture1.bind();
-            glDrawElements(GL_TRIANGLES, 24, GL_UNSIGNED_INT, 0);
-            glAttributes.disable();
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            // The shader picks each surface's texture by its material, so every material is bound at once
+            for (int material = 0; material < NUM_MATERIALS; material++)
+                residency.bind(material, material);
 
-            vertexBuffers[1]->bind();
-            glAttributes.enable();
-            glActiveTexture(GL_TEXTURE1);
-            texture2.bind();
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, (GLsizei)geometry->indices.size(), GL_UNSIGNED_INT, 0);
             glAttributes.disable();
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-            vertexBuffers[2]->bind();
-            glAttributes.enable();
-            glActiveTexture(GL_TEXTURE2);
-            texture3.bind();
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-            glAttributes.disable();
-
         }
 
-        struct VertexBuffer
+        void deleteBuffers()
         {
-            explicit VertexBuffer(std::vector<float> verticesIn, int numTriangles)
-            {
-                using namespace ::juce::gl;
-
-                numberTriangles = numTriangles;
-
-                glGenBuffers(1, &vertexBuffer);
-                glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-
-                juce::Array<Vertex> vertices;
-                for (auto i = 0; i < verticesIn.size(); i += 6)
-                {
-                    vertices.add({ { verticesIn.at(i), verticesIn.at(i + 1), verticesIn.at(i + 2) },
-                        { verticesIn.at(i + 3) , verticesIn.at(i + 4) },
-                        { verticesIn.at(i + 5) } });
-                }
-
-                glBufferData(GL_ARRAY_BUFFER,
-                    static_cast<GLsizeiptr> (static_cast<size_t> (vertices.size()) * sizeof(Vertex)),
-                    vertices.getRawDataPointer(), GL_STATIC_DRAW);
-
-                glGenBuffers(1, &indexBuffer);
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-            }
-
-            ~VertexBuffer()
-            {
-                using namespace ::juce::gl;
+            using namespace ::juce::gl;
 
+            if (vertexBuffer != 0)
                 glDeleteBuffers(1, &vertexBuffer);
+            if (indexBuffer != 0)
                 glDeleteBuffers(1, &indexBuffer);
-            }
-
-            void bind()
-            {
-                using namespace ::juce::gl;
-
-                glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-            }
-
-            GLuint vertexBuffer, indexBuffer;
-            int numberTriangles;
-
-            unsigned int indices[24] = {  // note that we start from 0!
-                0, 1, 3,   // first triangle
-                1, 2, 3,   // second triangle
-                4, 5, 7,   // first triangle
-                5, 6, 7,   // second triangle
-                8, 9, 11,   // first triangle
-                9, 10, 11,   // second triangle
-                12, 13, 15,   // first triangle
-                13, 14, 15    // second triangle
-            };
+            vertexBuffer = indexBuffer = 0;
+        }
 
+        static const int NUM_MATERIALS = 3;
 
-            JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VertexBuffer)
-        };
+        std::shared_ptr<const SceneGeometry> geometry; // the geometry in the buffers
+        GLuint vertexBuffer = 0, indexBuffer = 0;
+    };
 
-        struct TextureFromFile
+    // Uploads the textures of the TextureResidency with OpenGL
+    struct OpenGLTextureBackend : public TextureResidency::Backend
+    {
+        TextureResidency::Handle upload(const MaterialTexture& texture) override
         {
-            TextureFromFile(const File& file)
-            {
-                name = file.getFileName();
-                image = ImageFileFormat::loadFrom(file);
-                jassert(!image.isNull());
-            }
-
-            Image image;
-            String name;
+            using namespace ::juce::gl;
 
-            bool applyTo(OpenGLTexture& texture)
-            {
-                texture.loadImage(image);
-                return false;
-            }
-        };
+            GLuint handle = 0;
+            glGenTextures(1, &handle);
+            glBindTexture(GL_TEXTURE_2D, handle);
 
-        struct TextureFromBinary
-        {
-            TextureFromBinary(const void* data, size_t size, juce::String resourceName)
-            {
-                name = std::move(resourceName);
-                image = ImageFileFormat::loadFrom(data, size);
-                jassert(!image.isNull());
-            }
+            // Texture parameters are state of the texture, so they are set once here rather than on every draw
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
 
-            Image image;
-            String name;
+            // The mip chain was generated when the material was decoded
+            for (size_t level = 0; level < texture.levels.size(); level++)
+                glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA, texture.levels[level].width, texture.levels[level].height,
+                    0, JUCE_RGBA_FORMAT, GL_UNSIGNED_BYTE, texture.levels[level].pixels.data());
 
-            bool applyTo(OpenGLTexture& texture)
-            {
-                texture.loadImage(image);
-                return false;
-            }
-        };
+            glBindTexture(GL_TEXTURE_2D, 0);
+            return (TextureResidency::Handle)handle;
+        }
 
-        juce::OwnedArray<VertexBuffer> vertexBuffers;
-        OwnedArray<TextureFromBinary> textures;
-        OpenGLTexture texture1, texture2, texture3;
+        void release(TextureResidency::Handle handle) override
+        {
+            using namespace ::juce::gl;
 
-        Vector3D<float> roomSize;
+            GLuint texture = (GLuint)handle;
+            glDeleteTextures(1, &texture);
+        }
 
+        void bind(TextureResidency::Handle handle, int textureUnit) override
+        {
+            using namespace ::juce::gl;
 
+            glActiveTexture((GLenum)(GL_TEXTURE0 + textureUnit));
+            glBindTexture(GL_TEXTURE_2D, handle);
+        }
     };
 
     float width = 300.0f, height = 300.0f;
@@ -380,18 +327,36 @@ private:
     std::unique_ptr<Shape> shape;
     std::unique_ptr<Attributes> attributes;
     std::unique_ptr<Uniforms> uniforms;
+    OpenGLTextureBackend textureBackend;
+    TextureResidency textureResidency{ textureBackend };
+    juce::SharedResourcePointer<MaterialLibrary> materialLibrary;
 
     Camera camera;
     Vector3D<float> roomSize, cameraPos, roomPos;
+    static Vector3D<float> toVector3D(Vector3<float> v) { return { v.x, v.y, v.z }; } // the scene's vectors are the engine's own, see Vector3.h
     float lastX = 0.0f, lastY = 0.0f;
     bool firstMouse = true;
 
-    juce::OpenGLContext openGLContext;
+    FrameScheduler frameScheduler;
+    juce::uint64 sceneVersion = 0; // version of the last scene snapshot seen by checkForSceneChanges()
+    static constexpr float KEY_MOVEMENT_TIME = 0.05f; // seconds of camera movement per key press
 
     juce::Point<int> mousePosition;
     std::unique_ptr<MyMouseListener> myMouseListener;
 
-    std::shared_ptr<SharedData> sharedData;
+    SharedDataState& sharedData;
+
+    // Ray paths streamed from the tracer, drawn as one line buffer
+    void drawRayPaths(const Matrix3D<float>& projection, const Matrix3D<float>& view);
+
+    RayPathRing& rayPaths;
+    RayPathLines rayLines;
+    std::vector<RaySegment> newSegments;
+    std::unique_ptr<juce::OpenGLShaderProgram> lineShader;
+    std::unique_ptr<LineAttributes> lineAttributes;
+    std::unique_ptr<Uniforms> lineUniforms;
+    GLuint lineBuffer = 0;
+    static const int MAX_SEGMENTS_PER_FRAME = 4096; // more are left for the next frames, so a burst can't stall one
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RoomRender)
 };
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "TextureResidency.h"
+
+TextureResidency::TextureResidency(Backend& textureBackend) : backend(textureBackend)
+{
+}
+
+void TextureResidency::setTexture(int slot, const juce::String& material, std::shared_ptr<const MaterialTexture> texture)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (slot >= (int)slots.size())
+        slots.resize((size_t)slot + 1);
+
+    auto& entry = slots[(size_t)slot];
+    if (entry.material == material && entry.texture != nullptr)
+        return;
+
+    entry.material = material;
+    entry.texture = std::move(texture);
+    entry.dirty = true;
+}
+
+int TextureResidency::update()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int uploaded = 0;
+    for (auto& slot : slots)
+    {
+        if (!slot.dirty)
+            continue;
+
+        if (slot.handle != 0)
+            backend.release(slot.handle);
+
+        slot.handle = slot.texture == nullptr ? 0 : backend.upload(*slot.texture);
+        slot.dirty = false;
+        uploaded++;
+    }
+
+    numUploads += uploaded;
+    return uploaded;
+}
+
+void TextureResidency::bind(int slot, int textureUnit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (slot < (int)slots.size() && slots[(size_t)slot].handle != 0)
+        backend.bind(slots[(size_t)slot].handle, textureUnit);
+}
+
+void TextureResidency::releaseAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& slot : slots)
+    {
+        if (slot.handle != 0)
+            backend.release(slot.handle);
+
+        slot.handle = 0;
+        slot.dirty = slot.texture != nullptr;
+    }
+}
+
+bool TextureResidency::isDirty(int slot) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return slot < (int)slots.size() && slots[(size_t)slot].dirty;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TextureResidencyTests : public juce::UnitTest
+{
+public:
+    TextureResidencyTests() : juce::UnitTest("TextureResidency", "RoomReverb") {}
+
+    // Hands out handles and records the GPU work instead of doing it
+    struct FakeBackend : public TextureResidency::Backend
+    {
+        TextureResidency::Handle upload(const MaterialTexture&) override { numUploads++; return ++lastHandle; }
+        void release(TextureResidency::Handle handle) override { released.push_back(handle); }
+        void bind(TextureResidency::Handle handle, int) override { bound.push_back(handle); }
+
+        int numUploads = 0;
+        TextureResidency::Handle lastHandle = 0;
+        std::vector<TextureResidency::Handle> released, bound;
+    };
+
+    void runTest() override
+    {
+        FakeBackend backend;
+        TextureResidency residency(backend);
+        auto brick = makeTexture("brick");
+        auto wood = makeTexture("wood");
+
+        beginTest("Slots are uploaded once per material");
+        {
+            residency.setTexture(0, "brick", brick);
+            residency.setTexture(1, "wood", wood);
+            expect(residency.isDirty(0) && residency.isDirty(1));
+            expectEquals(residency.update(), 2);
+            expectEquals(residency.update(), 0);
+
+            residency.setTexture(0, "brick", brick);
+            expect(!residency.isDirty(0));
+            expectEquals(residency.update(), 0);
+            expectEquals(backend.numUploads, 2);
+        }
+
+        beginTest("A new material replaces the slot's GPU copy");
+        {
+            residency.setTexture(0, "wood", wood);
+            expect(residency.isDirty(0));
+            expectEquals(residency.update(), 1);
+            expect(backend.released == std::vector<TextureResidency::Handle>{ 1 });
+
+            residency.bind(0, 0);
+            expect(backend.bound == std::vector<TextureResidency::Handle>{ 3 });
+        }
+
+        beginTest("releaseAll() makes the slots dirty until they're uploaded again");
+        {
+            backend.released.clear();
+            backend.bound.clear();
+            residency.releaseAll();
+
+            expect(backend.released == std::vector<TextureResidency::Handle>{ 3, 2 });
+            expect(residency.isDirty(0) && residency.isDirty(1));
+
+            // Nothing is resident to bind until the next update
+            residency.bind(0, 0);
+            expect(backend.bound.empty());
+
+            expectEquals(residency.update(), 2);
+            expect(!residency.isDirty(0) && !residency.isDirty(1));
+            expectEquals(backend.released.size(), (size_t)2);
+            expectEquals(residency.getNumUploads(), 5);
+
+            residency.bind(1, 2);
+            expect(backend.bound == std::vector<TextureResidency::Handle>{ 5 });
+        }
+    }
+
+private:
+    static std::shared_ptr<const MaterialTexture> makeTexture(const juce::String& name)
+    {
+        auto texture = std::make_shared<MaterialTexture>();
+        texture->name = name;
+        texture->levels.resize(1);
+        texture->levels[0].width = texture->levels[0].height = 1;
+        texture->levels[0].pixels.assign(4, 255);
+        return texture;
+    }
+};
+
+static TextureResidencyTests textureResidencyTests;
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <mutex>
+#include <vector>
+#include <JuceHeader.h>
+#include "MaterialLibrary.h"
+
+/***************************************************************/
+// Keeps the room's textures resident on the GPU.
+//
+// Each slot (one per material) holds the decoded texture and the
+// handle of its GPU copy. A slot is only uploaded, with its
+// mipmaps, when its material changes or the GPU copies have been
+// released, so the frames in between just bind it. The GPU work
+// is behind the Backend interface, so this class has no OpenGL
+// dependency of its own.
+/***************************************************************/
+class TextureResidency
+{
+public:
+    using Handle = unsigned int; // 0 means not resident
+
+    class Backend
+    {
+    public:
+        virtual ~Backend() = default;
+
+        /** Creates a GPU copy of the texture, with its mip chain, and returns its handle. */
+        virtual Handle upload(const MaterialTexture& texture) = 0;
+        virtual void release(Handle handle) = 0;
+        virtual void bind(Handle handle, int textureUnit) = 0;
+    };
+
+    explicit TextureResidency(Backend& backend);
+
+    /** Sets the material of a slot. Nothing is uploaded if the slot already holds the same material. Safe to call from any thread. */
+    void setTexture(int slot, const juce::String& material, std::shared_ptr<const MaterialTexture> texture);
+
+    /** Uploads the slots whose material has changed. Call on the rendering thread before drawing. Returns the number uploaded. */
+    int update();
+
+    /** Binds a resident slot to a texture unit. */
+    void bind(int slot, int textureUnit);
+
+    /** Releases every GPU copy, e.g. when the context goes away. The textures are kept, so update() uploads them again. */
+    void releaseAll();
+
+    bool isDirty(int slot) const;
+    int getNumUploads() const { return numUploads; }
+
+private:
+    struct Slot {
+        juce::String material;
+        std::shared_ptr<const MaterialTexture> texture;
+        Handle handle = 0;
+        bool dirty = false;
+    };
+
+    Backend& backend;
+    mutable std::mutex mutex;
+    std::vector<Slot> slots;
+    int numUploads = 0;
+};
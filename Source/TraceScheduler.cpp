@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#include "TraceScheduler.h"
+
+TraceScheduler::TraceScheduler()
+{
+    int numWorkers = getNumWorkers();
+    running.resize(numWorkers);
+    for (int i = 0; i < numWorkers; i++)
+    {
+        workers.push_back(std::make_unique<Worker>(*this, i));
+        workers.back()->startThread();
+    }
+}
+
+TraceScheduler::~TraceScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+        for (auto& entry : running)
+            if (entry.job != nullptr)
+                entry.job->cancel();
+    }
+
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+    for (auto& worker : workers)
+        worker->stopThread(4000);
+}
+
+/***************************************************************/
+// Each job traces on a single thread, so jobs of different
+// instances run in parallel. Half the cores are left for audio.
+/***************************************************************/
+int TraceScheduler::getNumWorkers()
+{
+    return juce::jmax(1, juce::SystemStats::getNumCpus() / 2);
+}
+
+void TraceScheduler::submit(const void* owner, std::shared_ptr<TraceJob> job, int priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // The owner's older jobs are for a scene it no longer has
+        queue.erase(std::remove_if(queue.begin(), queue.end(), [owner](const Entry& e) { return e.owner == owner; }), queue.end());
+        for (auto& entry : running)
+            if (entry.owner == owner && entry.job != nullptr)
+                entry.job->cancel();
+
+        Entry entry;
+        entry.owner = owner;
+        entry.sceneHash = ProcessReflections::hashScene(*job->scene);
+        entry.job = std::move(job);
+        entry.priority = priority;
+        entry.sequence = nextSequence++;
+        queue.push_back(std::move(entry));
+    }
+
+    wakeWorkers();
+}
+
+void TraceScheduler::setPriority(const void* owner, int priority)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& entry : queue)
+        if (entry.owner == owner)
+            entry.priority = priority;
+}
+
+void TraceScheduler::cancelJobs(const void* owner)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    queue.erase(std::remove_if(queue.begin(), queue.end(), [owner](const Entry& e) { return e.owner == owner; }), queue.end());
+
+    // The running job calls back into its owner, so it has to stop before the owner goes away
+    for (auto& entry : running)
+        if (entry.owner == owner && entry.job != nullptr)
+            entry.job->cancel();
+    jobFinished.wait(lock, [this, owner] { return !isRunning(owner); });
+}
+
+bool TraceScheduler::isRunning(const void* owner) const
+{
+    return std::any_of(running.begin(), running.end(), [owner](const Entry& e) { return e.owner == owner; });
+}
+
+bool TraceScheduler::takeNextJob(int worker, Entry& entry)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Jobs for a scene that is already being traced wait for its result
+    auto isBeingTraced = [this](const Entry& e) {
+        return std::any_of(running.begin(), running.end(), [&e](const Entry& r) { return r.job != nullptr && r.sceneHash == e.sceneHash; });
+    };
+
+    auto next = queue.end();
+    for (auto candidate = queue.begin(); candidate != queue.end(); ++candidate)
+    {
+        if (isBeingTraced(*candidate))
+            continue;
+
+        if (next == queue.end() || candidate->priority > next->priority
+            || (candidate->priority == next->priority && candidate->sequence < next->sequence))
+            next = candidate;
+    }
+
+    if (next == queue.end())
+        return false;
+
+    entry = std::move(*next);
+    queue.erase(next);
+    running[worker] = entry;
+    return true;
+}
+
+void TraceScheduler::finishJob(int worker)
+{
+    bool jobsWaiting;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running[worker] = Entry();
+        jobsWaiting = !queue.empty();
+    }
+
+    jobFinished.notify_all();
+
+    // Jobs for the scene just traced can run now
+    if (jobsWaiting)
+        wakeWorkers();
+}
+
+void TraceScheduler::wakeWorkers()
+{
+    for (auto& worker : workers)
+        worker->notify();
+}
+
+void TraceScheduler::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        Entry entry;
+        if (!scheduler.takeNextJob(index, entry))
+        {
+            wait(-1);
+            continue;
+        }
+
+        entry.job->start();
+        auto result = tracer.run(*entry.job);
+        if (result != nullptr && !entry.job->isCancelled() && entry.job->onComplete)
+            entry.job->onComplete(result);
+
+        scheduler.finishJob(index);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <JuceHeader.h>
+
+/***************************************************************/
+// Runs the trace jobs of every plugin instance in the process.
+//
+// Each owner (a plugin instance) has at most one job queued:
+// submitting a new one replaces it and cancels the owner's
+// running job, so rapid scene changes only trace the newest
+// scene. Queued jobs run highest priority first, then oldest
+// first, on a pool of workers sized to the machine. A job for a
+// scene another worker is already tracing waits for that trace,
+// then picks its result up from the IRStore.
+/***************************************************************/
+class TraceScheduler
+{
+public:
+    enum Priority
+    {
+        background = 0,
+        visibleEditor = 1,
+        offlineRender = 2 // a bounce is waiting on it
+    };
+
+    TraceScheduler();
+    ~TraceScheduler();
+
+    /** Queues a job for the owner, replacing any job it already has queued or running. */
+    void submit(const void* owner, std::shared_ptr<TraceJob> job, int priority);
+
+    /** Changes the priority of the owner's queued job. */
+    void setPriority(const void* owner, int priority);
+
+    /** Cancels the owner's jobs, and waits for the running one to stop. */
+    void cancelJobs(const void* owner);
+
+private:
+    struct Entry {
+        const void* owner = nullptr;
+        std::shared_ptr<TraceJob> job;
+        juce::uint64 sceneHash = 0;
+        int priority = background;
+        juce::uint64 sequence = 0;
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(TraceScheduler& owner, int workerIndex) : juce::Thread("TraceScheduler"), scheduler(owner), index(workerIndex) {}
+        void run() override;
+
+    private:
+        TraceScheduler& scheduler;
+        const int index;
+        ProcessReflections tracer;
+    };
+
+    static int getNumWorkers();
+    bool isRunning(const void* owner) const;
+    bool takeNextJob(int worker, Entry& entry);
+    void finishJob(int worker);
+    void wakeWorkers();
+
+    std::mutex mutex;
+    std::condition_variable jobFinished;
+    std::vector<Entry> queue;
+    std::vector<Entry> running; // by worker
+    juce::uint64 nextSequence = 0;
+    std::vector<std::unique_ptr<Worker>> workers;
+};
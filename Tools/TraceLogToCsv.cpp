@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2025 James G. Stanier
+ *
+ * This file is part of RoomReverbPlugin.
+ *
+ * This software is dual-licensed under:
+ *   1. The GNU General Public License v3.0 (GPLv3)
+ *   2. A commercial license (contact j.stanier766(at)gmail.com for details)
+ *
+ * You may use this file under the terms of the GPLv3 as published by
+ * the Free Software Foundation. For proprietary/commercial use,
+ * please see the LICENSE-COMMERCIAL file or contact the copyright holder.
+ */
+
+
+/***************************************************************/
+// Converts a binary trace log (see Modules/roomreverb_core/tracing/TraceLog.h) to CSV.
+//
+//     TraceLogToCsv <log.rrlog> [output prefix]
+//
+// Prints the scene from the log's header, then writes the rays,
+// hits and taps to <prefix>-rays.csv, <prefix>-hits.csv and
+// <prefix>-taps.csv; the prefix defaults to the log's name
+// without its extension. Plain C++17, so it builds without JUCE:
+//
+//     c++ -std=c++17 -O2 -I Modules/roomreverb_core/tracing Tools/TraceLogToCsv.cpp -o TraceLogToCsv
+/***************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "TraceLogFormat.h"
+
+namespace
+{
+    struct CsvFile {
+        FILE* file = nullptr;
+
+        CsvFile(const std::string& path, const char* columns)
+        {
+            file = fopen(path.c_str(), "w");
+            if (file != nullptr)
+                fprintf(file, "%s\n", columns);
+            else
+                fprintf(stderr, "Can't write %s\n", path.c_str());
+        }
+
+        ~CsvFile()
+        {
+            if (file != nullptr)
+                fclose(file);
+        }
+    };
+
+    void printHeader(const TraceLogHeader& header)
+    {
+        printf("Scene %016llx\n", (unsigned long long)header.sceneHash);
+        printf("  room size %g %g %g, position %g %g %g\n", header.roomSize[0], header.roomSize[1], header.roomSize[2],
+            header.roomPos[0], header.roomPos[1], header.roomPos[2]);
+        printf("  listener position %g %g %g, size %g %g %g\n", header.listenerPos[0], header.listenerPos[1], header.listenerPos[2],
+            header.listenerSize[0], header.listenerSize[1], header.listenerSize[2]);
+        printf("  %d sources, %d receivers (grid %d x %d x %d), %d reflections\n", header.numSources, header.numReceivers,
+            header.receiverGrid[0], header.receiverGrid[1], header.receiverGrid[2], header.numReflections);
+        printf("  speed of sound %g, roll off %g, delay bucket %g ms\n", header.speedOfSound, header.rollOff, header.delayBucketSize);
+        printf("  %d additional rays, %d polar buckets, %d refinement rounds, tolerance %g\n", header.additionalRays,
+            header.numberPolarBuckets, header.maxRefinementRounds, header.refinementTolerance);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <log.rrlog> [output prefix]\n", argv[0]);
+        return 1;
+    }
+
+    std::string logPath = argv[1];
+    std::string prefix = argc > 2 ? argv[2] : logPath.substr(0, logPath.rfind(".rrlog"));
+
+    FILE* log = fopen(logPath.c_str(), "rb");
+    if (log == nullptr)
+    {
+        fprintf(stderr, "Can't open %s\n", logPath.c_str());
+        return 1;
+    }
+
+    TraceLogHeader header;
+    if (fread(&header, sizeof(header), 1, log) != 1 || memcmp(header.magic, TraceLogFormat::magic, sizeof(header.magic)) != 0
+        || header.version != TraceLogFormat::version)
+    {
+        fprintf(stderr, "%s is not a version %u trace log\n", logPath.c_str(), TraceLogFormat::version);
+        fclose(log);
+        return 1;
+    }
+
+    printHeader(header);
+
+    CsvFile rays(prefix + "-rays.csv", "source,origin,x,y,z,hits");
+    CsvFile hits(prefix + "-hits.csv", "source,origin,receiver,reflection,delay,azimuth,polar,weight");
+    CsvFile taps(prefix + "-taps.csv", "source,receiver,index,delay,azimuth,elevation,gain");
+    if (rays.file == nullptr || hits.file == nullptr || taps.file == nullptr)
+    {
+        fclose(log);
+        return 1;
+    }
+
+    size_t counts[4] = {};
+    std::vector<TraceLogRecord> records(4096);
+    size_t numRead;
+    while ((numRead = fread(records.data(), sizeof(TraceLogRecord), records.size(), log)) > 0)
+    {
+        for (size_t i = 0; i < numRead; i++)
+        {
+            const TraceLogRecord& r = records[i];
+            switch (r.type)
+            {
+            case TraceLogFormat::ray:
+                fprintf(rays.file, "%d,%d,%.9g,%.9g,%.9g,%d\n", r.source, r.index, r.values[0], r.values[1], r.values[2], (int)r.values[3]);
+                break;
+            case TraceLogFormat::hit:
+                fprintf(hits.file, "%d,%d,%d,%d,%.9g,%.9g,%.9g,%.9g\n", r.source, r.index, r.receiver, (int)r.reflection,
+                    r.values[0], r.values[1], r.values[2], r.values[3]);
+                break;
+            case TraceLogFormat::tap:
+                fprintf(taps.file, "%d,%d,%d,%.9g,%.9g,%.9g,%.9g\n", r.source, r.receiver, r.index,
+                    r.values[0], r.values[1], r.values[2], r.values[3]);
+                break;
+            default:
+                continue;
+            }
+            counts[r.type]++;
+        }
+    }
+
+    fclose(log);
+    printf("%zu rays, %zu hits, %zu taps\n", counts[TraceLogFormat::ray], counts[TraceLogFormat::hit], counts[TraceLogFormat::tap]);
+    return 0;
+}